@@ -0,0 +1,71 @@
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "game_analytics.hpp"
+
+using namespace tictactoe;
+
+int main(int argc, const char * const argv[]) {
+	unsigned threads = 0;
+	field::size_type opening_depth = 4, max_openings = 20;
+	bool valid_options = 1 < argc;
+
+	for(int arg = 2; arg < argc; arg += 2) {
+		const std::string option(argv[arg]);
+		std::stringstream value((arg + 1 < argc) ? argv[arg + 1] : "");
+		unsigned long number = 0;
+
+		if (!(value >> number)) {
+			valid_options = false;
+		}
+		else if ("--threads" == option) {
+			threads = number;
+		}
+		else if ("--depth" == option) {
+			opening_depth = number;
+		}
+		else if ("--openings" == option) {
+			max_openings = number;
+		}
+		else {
+			valid_options = false;
+		}
+	}
+
+	if (!valid_options) {
+		std::cerr <<
+			"Usage:\n"
+			"\t" << argv[0] << " <records> [<options>]\n"
+			"\n"
+			"Replays a file of game records in the format described in\n"
+			"game_records.hpp and prints win rates, move heatmaps and the\n"
+			"most frequent openings.\n"
+			"\n"
+			"<records>\n"
+			"\tThe record file, or \"-\" to read from stdin.\n"
+			"--threads <n>\n"
+			"\tThe number of worker threads (default: one per hardware thread).\n"
+			"--depth <n>\n"
+			"\tThe number of moves counted as opening (default: 4).\n"
+			"--openings <n>\n"
+			"\tThe number of most frequent openings to print (default: 20).\n";
+		return 1;
+	}
+
+	std::ios::sync_with_stdio(false);
+	try {
+		const std::string path(argv[1]);
+		const game_statistics stats = ("-" == path)
+			? analyze_game_records(std::cin, threads, opening_depth)
+			: analyze_game_records(path, threads, opening_depth);
+		stats.print(std::cout, max_openings);
+	}
+	catch(std::runtime_error &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return 1;
+	}
+
+	return 0;
+}
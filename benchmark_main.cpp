@@ -0,0 +1,505 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#	include <poll.h>
+#	include <sys/socket.h>
+#	include <unistd.h>
+#endif
+
+#include "evaluation_service.hpp"
+#include "field.hpp"
+#include "field_position.hpp"
+#include "game.hpp"
+#include "game_analytics.hpp"
+#include "game_records.hpp"
+#include "parallel_searcher.hpp"
+#include "pattern_evaluator.hpp"
+#include "proof_solver.hpp"
+#include "searcher.hpp"
+#include "self_play.hpp"
+#include "simulation.hpp"
+#include "spectator.hpp"
+#include "tracing.hpp"
+#include "transposition_table.hpp"
+
+using namespace tictactoe;
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	struct benchmark_position {
+		std::string description;
+		field position;
+		field::tile current_player;
+		unsigned depth;
+	};
+
+	/**
+	 * Creates a field from a string of 'X', 'O' and '.' characters, row by
+	 * row.
+	 */
+	field parse_field(const std::string &tiles, field::size_type order, field::size_type win_length) {
+		field result(order, win_length);
+		for(field::size_type index = 0; index < result.size(); ++index) {
+			result[index] =
+				('X' == tiles.at(index)) ? field::tile::player1 :
+				('O' == tiles.at(index)) ? field::tile::player2 :
+				field::tile::empty;
+		}
+		return result;
+	}
+
+	/**
+	 * Searches a fixed suite of positions to a fixed depth with 1, 2, 4, 8 and
+	 * 16 threads and reports the time to depth and the speedup relative to a
+	 * single thread.
+	 */
+	void benchmark_parallel_search() {
+		const std::vector<benchmark_position> suite = {
+			{ "4x4, 4 in a row, empty", field(4, 4), field::tile::player1, 9 },
+			{ "4x4, 4 in a row, opening", parse_field(
+				"...."
+				".XO."
+				"...."
+				"....", 4, 4), field::tile::player1, 9 },
+			{ "5x5, 4 in a row, empty", field(5, 4), field::tile::player1, 6 },
+			{ "5x5, 4 in a row, middle game", parse_field(
+				"....."
+				".XO.."
+				"..X.."
+				"..O.."
+				".....", 5, 4), field::tile::player1, 7 },
+			{ "6x6, 4 in a row, opening", parse_field(
+				"......"
+				"......"
+				"..XO.."
+				"......"
+				"......"
+				"......", 6, 4), field::tile::player1, 5 }
+		};
+
+		std::cout << "Parallel search (Lazy SMP), time to depth:\n";
+		double single_thread_seconds = 0;
+		for(const unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+			transposition_table table(20);
+			parallel_searcher engine(table, threads);
+
+			std::uint64_t nodes = 0;
+			const clock_type::time_point start = clock_type::now();
+			for(const auto &entry : suite) {
+				table.clear();
+				search_limits limits;
+				limits.max_depth = entry.depth;
+				nodes += engine.search(entry.position, entry.current_player, limits).nodes;
+			}
+			const double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+			if (1 == threads) {
+				single_thread_seconds = seconds;
+			}
+
+			std::cout <<
+				"  " << std::setw(2) << threads << " threads: " <<
+				std::fixed << std::setprecision(3) << seconds << "s, " <<
+				std::setprecision(2) << (single_thread_seconds / seconds) << "x speedup, " <<
+				static_cast<std::uint64_t>(nodes / seconds) << " nodes/s\n";
+		}
+	}
+
+	/**
+	 * Sends 100000 random 3x3 and 4x4 positions through the evaluation
+	 * service and reports its throughput and batch latencies.
+	 */
+	void benchmark_evaluation_service() {
+		std::mt19937 gen(12345);
+		std::stringstream requests, responses;
+		const std::uint32_t num_queries = 100000;
+		for(std::uint32_t id = 0; id < num_queries; ++id) {
+			const field::size_type order = (id % 4) ? 3 : 4;
+			evaluation_query query = { id, field(order, 3), field::tile::player1 };
+
+			// play a random number of random moves
+			const field::size_type num_moves = std::uniform_int_distribution<field::size_type>(0, order * order - 1)(gen);
+			for(field::size_type move = 0; move < num_moves; ++move) {
+				field::size_type index;
+				do {
+					index = std::uniform_int_distribution<field::size_type>(0, order * order - 1)(gen);
+				} while(query.position[index] != field::tile::empty);
+				query.position[index] = query.current_player;
+				query.current_player = (query.current_player == field::tile::player1)
+					? field::tile::player2
+					: field::tile::player1;
+			}
+			write_query(requests, query);
+		}
+
+		evaluation_service service;
+		service.run(requests, responses);
+
+		const evaluation_service::statistics &stats = service.stats();
+		std::cout <<
+			"Evaluation service, " << stats.queries << " queries in " << stats.batches << " batches:\n"
+			"  " << stats.evaluations << " evaluations, " << stats.cache_hits << " cache hits\n"
+			"  " << static_cast<std::uint64_t>(stats.queries_per_second()) << " queries/s\n"
+			"  batch latency p50 / p99 / max: " <<
+				stats.batch_latency(50).count() * 1000 << "ms / " <<
+				stats.batch_latency(99).count() * 1000 << "ms / " <<
+				stats.batch_latency(100).count() * 1000 << "ms\n";
+	}
+
+	/**
+	 * Replays 1000000 random 5x5 games from memory with 1, 2, 4 and 8
+	 * threads and reports the throughput.
+	 */
+	void benchmark_game_analytics() {
+		std::mt19937 gen(12345);
+		std::stringstream records;
+		const std::uint32_t num_games = 1000000;
+		game_records::write_header(records, 5, 4);
+		for(std::uint32_t game = 0; game < num_games; ++game) {
+			field_position position(5, 4);
+			std::vector<field::size_type> moves;
+			while(position.game_status() == field_position::status::ongoing) {
+				field::size_type index;
+				do {
+					index = std::uniform_int_distribution<field::size_type>(0, position.size() - 1)(gen);
+				} while(!position.is_legal(index));
+				position.make_move(index);
+				moves.push_back(index);
+			}
+			game_records::write_game(records, moves.data(), moves.size());
+		}
+		const std::string data = records.str();
+
+		std::cout << "Game analytics, " << num_games << " games (" << data.size() << " bytes):\n";
+		for(const unsigned threads : {1u, 2u, 4u, 8u}) {
+			const game_statistics stats = analyze_game_records(
+				reinterpret_cast<const unsigned char *>(data.data()), data.size(), threads, 4);
+			std::cout <<
+				"  " << threads << " threads: " << std::fixed << std::setprecision(3) << stats.elapsed.count() << "s, " <<
+				static_cast<std::uint64_t>(stats.results.games / stats.elapsed.count()) << " games/s, " <<
+				stats.openings.size() << " distinct openings\n";
+		}
+	}
+
+	/**
+	 * Evaluates every position of random 15x15 games with 5 in a row, once
+	 * by rescanning the field and once incrementally, and reports the
+	 * evaluations per second.
+	 */
+	void benchmark_pattern_evaluator() {
+		std::mt19937 gen(12345);
+		std::vector<std::vector<field::size_type>> games(200);
+		for(auto &moves : games) {
+			field_position position(15, 5);
+			while(position.game_status() == field_position::status::ongoing) {
+				field::size_type index;
+				do {
+					index = std::uniform_int_distribution<field::size_type>(0, position.size() - 1)(gen);
+				} while(!position.is_legal(index));
+				position.make_move(index);
+				moves.push_back(index);
+			}
+		}
+
+		std::uint64_t evaluations = 0;
+		std::int64_t checksum = 0;
+		clock_type::time_point start = clock_type::now();
+		for(const auto &moves : games) {
+			field_position position(15, 5);
+			for(const field::size_type move : moves) {
+				position.make_move(move);
+				checksum += searcher::evaluate(position);
+				++evaluations;
+			}
+		}
+		const std::chrono::duration<double> full_seconds = clock_type::now() - start;
+
+		// make and take back every move, like a search does
+		start = clock_type::now();
+		for(const auto &moves : games) {
+			field_position position(15, 5);
+			pattern_evaluator evaluator(position);
+			for(const field::size_type move : moves) {
+				evaluator.make_move(move, position.current_player());
+				position.make_move(move);
+				checksum -= evaluator.evaluate(position.current_player());
+			}
+			while(position.moves_played()) {
+				evaluator.unmake_move(position.last_move());
+				position.unmake_move();
+			}
+		}
+		const std::chrono::duration<double> incremental_seconds = clock_type::now() - start;
+
+		std::cout <<
+			"Pattern evaluation, 15x15 with 5 in a row, " << evaluations << " positions" <<
+			(checksum ? " (MISMATCH)" : "") << ":\n"
+			"  full scan:   " << static_cast<std::uint64_t>(evaluations / full_seconds.count()) << " evaluations/s\n"
+			"  incremental: " << static_cast<std::uint64_t>(evaluations / incremental_seconds.count()) << " evaluations/s\n";
+	}
+
+	/**
+	 * Plays 1000000 games of self-play with different batch sizes and
+	 * reports the games per second on a single core.
+	 */
+	void benchmark_self_play() {
+		const struct {
+			const char *description;
+			field::size_type order;
+			bool table;
+		} setups[] = {
+			{ "3x3, computer player's table, 10% random moves", 3, true },
+			{ "3x3, random moves", 3, false },
+			{ "5x5, 4 in a row, random moves", 5, false }
+		};
+
+		std::cout << "Lockstep self-play, 1000000 games per setup:\n";
+		for(const auto &setup : setups) {
+			std::cout << "  " << setup.description << ":\n";
+			for(const std::size_t batch_size : {1u, 64u, 4096u}) {
+				table_policy computer_moves(0.1, 12345);
+				random_policy random_moves(12345);
+				self_play_driver driver(setup.order, (5 == setup.order) ? 4 : 0, batch_size);
+				const self_play_statistics stats = setup.table
+					? driver.run(computer_moves, 1000000)
+					: driver.run(random_moves, 1000000);
+				std::cout <<
+					"    batch size " << std::setw(4) << batch_size << ": " <<
+					static_cast<std::uint64_t>(stats.games_per_second()) << " games/s/core\n";
+			}
+		}
+	}
+
+	/**
+	 * Plays 100000 games between random players on a 3x3 field, once
+	 * through the virtual player interface and once statically dispatched,
+	 * and reports the games per second.
+	 */
+	void benchmark_simulation() {
+		const unsigned num_games = 100000;
+		simulation::random_player random1(1), random2(2);
+
+		// game() prints every move, which is not what is measured here
+		std::stringstream discarded;
+		std::streambuf * const console = std::cout.rdbuf(discarded.rdbuf());
+		simulation::dynamic_player<simulation::random_player> dynamic1(random1, "random 1"), dynamic2(random2, "random 2");
+		clock_type::time_point start = clock_type::now();
+		for(unsigned game_number = 0; game_number < num_games; ++game_number) {
+			game(dynamic1, dynamic2);
+			discarded.str(std::string());
+		}
+		const std::chrono::duration<double> dynamic_seconds = clock_type::now() - start;
+		std::cout.rdbuf(console);
+
+		start = clock_type::now();
+		unsigned player1_wins = 0;
+		for(unsigned game_number = 0; game_number < num_games; ++game_number) {
+			player1_wins += (simulation::game(random1, random2) == field::tile::player1);
+		}
+		const std::chrono::duration<double> static_seconds = clock_type::now() - start;
+
+		std::cout <<
+			"Random 3x3 games, " << num_games << " each (player 1 won " << player1_wins << " simulated games):\n"
+			"  virtual players:    " << static_cast<std::uint64_t>(num_games / dynamic_seconds.count()) << " games/s\n"
+			"  simulation::game(): " << static_cast<std::uint64_t>(num_games / static_seconds.count()) << " games/s\n";
+	}
+
+	/**
+	 * Solves empty fields of increasing size with the proof-number search and
+	 * reports the nodes per second and the memory used.
+	 */
+	void benchmark_proof_solver() {
+		const struct {
+			const char *description;
+			field::size_type order;
+			field::size_type win_length;
+		} suite[] = {
+			{ "3x3, 3 in a row", 3, 3 },
+			{ "4x4, 3 in a row", 4, 3 },
+			{ "4x4, 4 in a row", 4, 4 }
+		};
+
+		std::cout << "Proof-number search:\n";
+		for(const auto &entry : suite) {
+			proof_solver solver(std::size_t(64) << 20);
+			const proof_result result = solver.solve(field_position(entry.order, entry.win_length));
+			const proof_statistics &stats = solver.statistics();
+			std::cout <<
+				"  " << entry.description << ": " <<
+				((result == proof_result::win) ? "win" : (result == proof_result::loss) ? "loss" : (result == proof_result::draw) ? "draw" : "unknown") << ", " <<
+				stats.nodes << " nodes, " <<
+				std::fixed << std::setprecision(3) << stats.elapsed.count() << "s, " <<
+				static_cast<std::uint64_t>(stats.nodes_per_second()) << " nodes/s, " <<
+				stats.table_entries << " table entries, " <<
+				(stats.peak_memory >> 20) << " MiB peak memory\n";
+		}
+	}
+
+#ifndef _WIN32
+	/**
+	 * Broadcasts 1000 random games to 1000 spectators, read by a single
+	 * thread, and reports the time the game loop spends per move and how
+	 * many frames reach the spectators.
+	 */
+	void benchmark_spectators() {
+		const unsigned num_spectators = 1000, num_games = 1000;
+		std::vector<pollfd> readers;
+		spectator_broadcaster::statistics stats;
+		std::chrono::duration<double> publish_seconds(0), total_seconds(0);
+		std::uint64_t moves = 0, received = 0;
+		std::thread reader;
+		{
+			spectator_broadcaster spectators;
+			for(unsigned index = 0; index < num_spectators; ++index) {
+				int sockets[2];
+				if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets)) {
+					std::cout << "Spectators: cannot create " << num_spectators << " socket pairs\n";
+					return;
+				}
+				spectators.subscribe(sockets[0]);
+				readers.push_back(pollfd { sockets[1], POLLIN, 0 });
+			}
+
+			reader = std::thread([&readers, &received]() {
+				char buffer[65536];
+				for(std::size_t open = readers.size(); open && 0 < poll(readers.data(), readers.size(), -1); ) {
+					for(pollfd &polled : readers) {
+						if (0 <= polled.fd && polled.revents) {
+							const ssize_t length = read(polled.fd, buffer, sizeof(buffer));
+							if (length <= 0) {
+								close(polled.fd);
+								polled.fd = -1;
+								--open;
+							}
+							received += (0 < length) ? length : 0;
+						}
+					}
+				}
+			});
+
+			std::mt19937 random(1);
+			const clock_type::time_point start = clock_type::now();
+			for(unsigned game_number = 0; game_number < num_games; ++game_number) {
+				field position;
+				const clock_type::time_point publish_start = clock_type::now();
+				spectators.start_game(position);
+				publish_seconds += clock_type::now() - publish_start;
+				field::tile player = field::tile::player1, winner = field::tile::empty;
+				for(field::size_type move = 0; move < position.size() && winner == field::tile::empty; ++move, ++moves) {
+					field::size_type index;
+					do {
+						index = random() % position.size();
+					} while(position[index] != field::tile::empty);
+					position[index] = player;
+					const clock_type::time_point move_start = clock_type::now();
+					spectators.move(position, index);
+					publish_seconds += clock_type::now() - move_start;
+					winner = position.check_win_condition(index) ? player : field::tile::empty;
+					player = (player == field::tile::player1) ? field::tile::player2 : field::tile::player1;
+				}
+				spectators.end_game(winner);
+			}
+			spectators.flush(std::chrono::seconds(60));
+			total_seconds = clock_type::now() - start;
+			stats = spectators.stats();
+		}
+		// the broadcaster has closed its sockets, which ends the reader
+		reader.join();
+
+		std::cout <<
+			"Spectators, " << num_games << " random 3x3 games to " << num_spectators << " spectators:\n"
+			"  game loop:  " << std::fixed << std::setprecision(2) << 1e6 * publish_seconds.count() / moves << " us/move\n"
+			"  fan-out:    " << static_cast<std::uint64_t>((stats.frames * num_spectators - stats.skipped_frames) / total_seconds.count()) << " frames/s delivered, " <<
+				stats.skipped_frames << " skipped, " <<
+				stats.bytes_sent / std::max<std::uint64_t>(1, stats.writes) << " bytes/write, " <<
+				received << " bytes received\n";
+	}
+#endif
+
+	/**
+	 * Reports the cost of a trace span while tracing is stopped, while 1 in
+	 * 100 spans is sampled and while every span is recorded.
+	 */
+	void benchmark_tracing() {
+		if (!tracing::available()) {
+			std::cout << "Tracing: compiled out (make TRACING=0)\n";
+			return;
+		}
+
+		const unsigned num_spans = 1000000;
+		const struct {
+			const char *description;
+			double sample_rate;
+		} suite[] = {
+			{ "stopped:     ", 0 },
+			{ "1% sampled:  ", 0.01 },
+			{ "all sampled: ", 1 }
+		};
+
+		std::cout << "Trace spans, " << num_spans << " each:\n";
+		for(const auto &entry : suite) {
+			if (0 < entry.sample_rate) {
+				tracing::start(entry.sample_rate);
+			}
+			const clock_type::time_point start = clock_type::now();
+			for(unsigned i = 0; i < num_spans; ++i) {
+				tracing::span span("benchmark");
+			}
+			const std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+			tracing::stop();
+			std::cout << "  " << entry.description << std::fixed << std::setprecision(1) << elapsed.count() / num_spans << " ns/span\n";
+		}
+	}
+}
+
+int main(int argc, const char * const argv[]) {
+	const struct {
+		const char *name;
+		void (*run)();
+	} benchmarks[] = {
+		{ "analytics", benchmark_game_analytics },
+		{ "parallel", benchmark_parallel_search },
+		{ "patterns", benchmark_pattern_evaluator },
+		{ "proof", benchmark_proof_solver },
+		{ "selfplay", benchmark_self_play },
+		{ "service", benchmark_evaluation_service },
+		{ "simulation", benchmark_simulation },
+#ifndef _WIN32
+		{ "spectators", benchmark_spectators },
+#endif
+		{ "tracing", benchmark_tracing }
+	};
+
+	const std::string benchmark = (1 < argc) ? argv[1] : "all";
+	bool found = false;
+	for(const auto &entry : benchmarks) {
+		if ("all" == benchmark || entry.name == benchmark) {
+			entry.run();
+			found = true;
+		}
+	}
+
+	if (!found) {
+		std::cerr <<
+			"Usage:\n"
+			"\t" << argv[0] << " [<benchmark>]\n"
+			"\n"
+			"<benchmark>\n"
+			"\tOne of \"all\" (default)";
+		for(const auto &entry : benchmarks) {
+			std::cerr << ", \"" << entry.name << '"';
+		}
+		std::cerr << ".\n";
+		return 1;
+	}
+
+	return 0;
+}
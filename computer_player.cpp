@@ -1,10 +1,12 @@
 #include "computer_player.hpp"
 
-#include <cassert>
+#include <algorithm>
 #include <iostream>
 #include <random>
 
 #include "game.hpp"
+#include "searcher.hpp"
+#include "tracing.hpp"
 #include "computer_state_table.inc"
 
 namespace {
@@ -21,11 +23,12 @@ namespace {
 
 #ifdef _WIN32
 		// Workaround for Windows: No working implementation of std::random_device available on MinGW w/ G++ 4.7.2
-		constexpr int rd = 12345;
+		constexpr int seed = 12345;
 #else
 		std::random_device rd;
+		const auto seed = rd();
 #endif
-		std::mt19937 gen(rd);
+		std::mt19937 gen(seed);
 
 		const std::ptrdiff_t max_rand_index =
 			(previous_name_index == num_names)
@@ -45,8 +48,10 @@ namespace {
 	}
 }
 
-tictactoe::computer_player::computer_player()
-: player_name(random_computer_name()) {
+tictactoe::computer_player::computer_player(std::chrono::milliseconds move_time, unsigned threads)
+: player_name(random_computer_name())
+, move_time(move_time)
+, num_threads(threads) {
 }
 
 std::string tictactoe::computer_player::name() const {
@@ -54,14 +59,15 @@ std::string tictactoe::computer_player::name() const {
 }
 
 void tictactoe::computer_player::make_move(game_make_move_interface game) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 	const field playfield(game.field());
 	playfield.print(std::cout);
 	std::cout << '\n';
 
 	const field::size_type
 		order = playfield.order(),
-		size  = playfield.size();
-	assert(order == 3 && "This AI will only work with a 3x3 playing field.");
+		size  = playfield.size(),
+		win_length = playfield.win_length();
 
 	field::size_type occupied_tiles = 0;
 	for(field::size_type index = 0; index < size; ++index) {
@@ -69,7 +75,8 @@ void tictactoe::computer_player::make_move(game_make_move_interface game) {
 	}
 
 	// Try to close a row
-	if (4 <= occupied_tiles) { // makes no sense before both players have two tiles
+	if (2 * (win_length - 1) <= occupied_tiles) { // makes no sense before both players have win_length-1 tiles
+		TICTACTOE_TRACE_SPAN("computer_player::close_row");
 		for(field::size_type index = 0; index < size; ++index) {
 			if (playfield[index] == field::tile::empty && playfield.check_win_condition(index, game.current_player())) {
 				game.make_move(index);
@@ -79,7 +86,8 @@ void tictactoe::computer_player::make_move(game_make_move_interface game) {
 	}
 
 	// Prevent opponet from closing
-	if (3 <= occupied_tiles) { // makes no sense before first place has two tiles
+	if (2 * win_length - 3 <= occupied_tiles) { // makes no sense before first place has win_length-1 tiles
+		TICTACTOE_TRACE_SPAN("computer_player::block_row");
 		for(field::size_type index = 0; index < size; ++index) {
 			if (playfield[index] == field::tile::empty && playfield.check_win_condition(index, game.opponent_player())) {
 				game.make_move(index);
@@ -89,10 +97,9 @@ void tictactoe::computer_player::make_move(game_make_move_interface game) {
 	}
 
 	// check move database for next move
-	{
-		assert(game.field().order() == 3 &&
-			"The move database only contains moves for 3x3 playing fields.");
-
+	// (it only contains moves for classic 3x3 playing fields)
+	if (order == 3 && win_length == 3) {
+		TICTACTOE_TRACE_SPAN("computer_player::state_table");
 		std::vector<game_make_move_interface> interfaces;
 		interfaces.reserve(8);
 		interfaces.emplace_back(game);
@@ -127,18 +134,26 @@ void tictactoe::computer_player::make_move(game_make_move_interface game) {
 		}
 	}
 
-	// Still around? Then we're already set up for a tie, so it doesn't matter
-	// Just take the first free field.
+	// Still around? Then search for the best move, making sure to commit it
+	// before the deadline of the match - a tenth of the time is kept in
+	// reserve for printing and committing the move.
 	{
-		for(field::size_type index = 0; index < size; ++index) {
-			try {
-				game.make_move(index);
-				return;
-			}
-			catch(rule_violation_exception &) {
-				// ignore and try next field - after all we don't care which
-				// one we get.
-			}
+		TICTACTOE_TRACE_SPAN("computer_player::search");
+		const std::chrono::steady_clock::time_point deadline = std::min(game.deadline(), start + move_time);
+		search_limits limits;
+		limits.deadline = start + (deadline - start) * 9 / 10;
+		// the first iteration ignores the deadline, but not the watchdog
+		limits.stop = &game.cancellation();
+
+		if (!engine) {
+			table.reset(new transposition_table(18));
+			engine.reset(new parallel_searcher(*table, num_threads));
 		}
+		const search_result result = engine->search(playfield, game.current_player(), limits);
+
+		std::cout <<
+			player_name << ": searched " << result.nodes << " nodes to depth " <<
+			result.depth << " (value " << result.value << ")\n";
+		game.make_move(result.move);
 	}
 }
@@ -1,21 +1,36 @@
 #ifndef TICTACTOE_COMPUTER_PLAYER_HPP
 #define TICTACTOE_COMPUTER_PLAYER_HPP
 
+#include <chrono>
+#include <memory>
+
+#include "parallel_searcher.hpp"
 #include "player.hpp"
+#include "transposition_table.hpp"
 
 namespace tictactoe {
 
 struct computer_player : player {
 	/**
 	 * Create a new computer player with a random name.
+	 * \param move_time The time to think about a move if the match does not
+	 *        impose a shorter limit.
+	 * \param threads The number of search threads, see parallel_searcher.
 	 */
-	computer_player();
+	explicit computer_player(
+		std::chrono::milliseconds move_time = std::chrono::milliseconds(1000),
+		unsigned threads = 1
+	);
 
 	std::string name() const override;
 	void make_move(game_make_move_interface) override;
 
 private:
 	std::string player_name;
+	std::chrono::milliseconds move_time;
+	unsigned num_threads;
+	std::unique_ptr<transposition_table> table;
+	std::unique_ptr<parallel_searcher> engine;
 };
 
 }
@@ -0,0 +1,409 @@
+#include "evaluation_service.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "symmetry.hpp"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	constexpr unsigned max_order = 16; // moves and depths have to fit the wire format
+	constexpr unsigned max_complete_order = 4; // larger fields cannot be searched completely
+
+	void write_bytes(std::ostream &os, std::uint64_t value, unsigned bytes) {
+		char buffer[8];
+		for(unsigned index = 0; index < bytes; ++index) {
+			buffer[index] = static_cast<char>((value >> (8 * index)) & 0xff);
+		}
+		os.write(buffer, bytes);
+	}
+
+	// returns false if nothing could be read at all, throws if only parts
+	// of the value could be read
+	bool read_bytes(std::istream &is, std::uint64_t &value, unsigned bytes) {
+		unsigned char buffer[8];
+		is.read(reinterpret_cast<char *>(buffer), bytes);
+		if (0 == is.gcount()) {
+			return false;
+		}
+		if (static_cast<unsigned>(is.gcount()) != bytes) {
+			throw std::runtime_error("Truncated input.");
+		}
+		value = 0;
+		for(unsigned index = 0; index < bytes; ++index) {
+			value |= static_cast<std::uint64_t>(buffer[index]) << (8 * index);
+		}
+		return true;
+	}
+
+	void read_required(std::istream &is, std::uint64_t &value, unsigned bytes) {
+		if (!read_bytes(is, value, bytes)) {
+			throw std::runtime_error("Truncated input.");
+		}
+	}
+
+	bool is_decided(const tictactoe::field &position) {
+		bool full = true;
+		for(tictactoe::field::size_type index = 0; index < position.size(); ++index) {
+			if (position[index] == tictactoe::field::tile::empty) {
+				full = false;
+			}
+			else if (position.check_win_condition(index)) {
+				return true;
+			}
+		}
+		return full;
+	}
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// wire format
+//
+
+bool tictactoe::read_query(std::istream &is, evaluation_query &query) {
+	std::uint64_t id, order, win_length, current_player;
+	if (!read_bytes(is, id, 4)) {
+		return false;
+	}
+	read_required(is, order, 1);
+	read_required(is, win_length, 1);
+	read_required(is, current_player, 1);
+
+	query.id = static_cast<std::uint32_t>(id);
+	const bool valid_header =
+		0 < order && order <= max_order &&
+		win_length <= order &&
+		(1 == current_player || 2 == current_player);
+	query.position = valid_header ? field(order, win_length) : field();
+	query.current_player = valid_header
+		? static_cast<field::tile>(current_player)
+		: field::tile::empty;
+
+	// the tiles have to be consumed in any case to stay in sync
+	const std::uint64_t num_tiles = order * order;
+	for(std::uint64_t first_tile = 0; first_tile < num_tiles; first_tile += 4) {
+		std::uint64_t packed;
+		read_required(is, packed, 1);
+		for(std::uint64_t index = first_tile; index < std::min(first_tile + 4, num_tiles); ++index, packed >>= 2) {
+			if (3 == (packed & 3)) {
+				query.current_player = field::tile::empty;
+			}
+			else if (valid_header) {
+				query.position[index] = static_cast<field::tile>(packed & 3);
+			}
+		}
+	}
+	return true;
+}
+
+void tictactoe::write_query(std::ostream &os, const evaluation_query &query) {
+	write_bytes(os, query.id, 4);
+	write_bytes(os, query.position.order(), 1);
+	write_bytes(os, query.position.win_length(), 1);
+	write_bytes(os, static_cast<unsigned>(query.current_player), 1);
+	for(field::size_type first_tile = 0; first_tile < query.position.size(); first_tile += 4) {
+		unsigned packed = 0;
+		for(field::size_type index = std::min(first_tile + 4, query.position.size()); first_tile < index--; ) {
+			packed = (packed << 2) | static_cast<unsigned>(query.position[index]);
+		}
+		write_bytes(os, packed, 1);
+	}
+}
+
+bool tictactoe::read_answer(std::istream &is, evaluation_answer &answer) {
+	std::uint64_t id, result, depth, move, value;
+	if (!read_bytes(is, id, 4)) {
+		return false;
+	}
+	read_required(is, result, 1);
+	read_required(is, depth, 1);
+	read_required(is, move, 2);
+	read_required(is, value, 2);
+
+	answer.id = static_cast<std::uint32_t>(id);
+	answer.result = static_cast<evaluation_answer::status>(result);
+	answer.depth = static_cast<std::uint8_t>(depth);
+	answer.move = static_cast<std::uint16_t>(move);
+	answer.value = static_cast<std::int16_t>(static_cast<std::uint16_t>(value));
+	return true;
+}
+
+void tictactoe::write_answer(std::ostream &os, const evaluation_answer &answer) {
+	write_bytes(os, answer.id, 4);
+	write_bytes(os, static_cast<unsigned>(answer.result), 1);
+	write_bytes(os, answer.depth, 1);
+	write_bytes(os, answer.move, 2);
+	write_bytes(os, static_cast<std::uint16_t>(answer.value), 2);
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::evaluation_service
+//
+
+tictactoe::evaluation_service::settings::settings()
+: threads(0)
+, limits()
+, position_time(0)
+, large_field_time(1000)
+, max_batch_size(4096)
+, batch_window(1000)
+, cache_size(1 << 20) {}
+
+double tictactoe::evaluation_service::statistics::queries_per_second() const {
+	return (elapsed.count() > 0)
+		? queries / elapsed.count()
+		: 0;
+}
+
+std::chrono::duration<double> tictactoe::evaluation_service::statistics::batch_latency(double percentile) const {
+	if (batch_latencies.empty()) {
+		return std::chrono::duration<double>(0);
+	}
+	std::vector<std::chrono::duration<double>> sorted(batch_latencies);
+	const std::size_t rank = std::min(
+		sorted.size() - 1,
+		static_cast<std::size_t>(percentile / 100 * sorted.size())
+	);
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+	return sorted[rank];
+}
+
+tictactoe::evaluation_service::evaluation_service(const settings &service_settings)
+: config(service_settings)
+, statistic()
+, table(22) {
+	if (0 == config.threads) {
+		config.threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	searchers.reserve(config.threads);
+	for(unsigned index = 0; index < config.threads; ++index) {
+		searchers.emplace_back(table);
+	}
+	if (1 < config.threads) {
+		workers.reset(new thread_pool(config.threads));
+	}
+}
+
+tictactoe::evaluation_service::cached_result tictactoe::evaluation_service::evaluate_canonical(const field &position, field::tile current_player, unsigned worker) {
+	cached_result result;
+	result.valid = !is_decided(position);
+	if (!result.valid) {
+		return result;
+	}
+
+	search_limits limits(config.limits);
+	std::chrono::milliseconds position_time = config.position_time;
+	if (
+		0 == position_time.count() && max_complete_order < position.order() &&
+		search_limits().max_depth == limits.max_depth
+	) {
+		position_time = config.large_field_time;
+	}
+	limits.deadline = (position_time.count())
+		? clock_type::now() + position_time
+		: clock_type::time_point::max();
+
+	const search_result searched = searchers[worker].search(position, current_player, limits);
+	result.move = searched.move;
+	result.value = searched.value;
+	result.depth = searched.depth;
+	return result;
+}
+
+std::vector<tictactoe::evaluation_answer> tictactoe::evaluation_service::evaluate(const std::vector<evaluation_query> &batch) {
+	const clock_type::time_point start = clock_type::now();
+
+	// fold the batch by symmetry: every distinct canonical position that is
+	// not cached yet becomes a job
+	struct job {
+		std::string key;
+		field position;
+		field::tile current_player;
+		cached_result result;
+	};
+	std::vector<job> jobs;
+	std::unordered_map<std::string, std::size_t> job_index;
+
+	const std::size_t cached = static_cast<std::size_t>(-1);
+	std::vector<std::size_t> query_job(batch.size(), cached);
+	std::vector<unsigned> query_symmetry(batch.size(), 0);
+	std::vector<cached_result> query_result(batch.size());
+
+	for(std::size_t index = 0; index < batch.size(); ++index) {
+		const evaluation_query &query = batch[index];
+		if (query.current_player == field::tile::empty) {
+			query_result[index].valid = false;
+			continue;
+		}
+
+		std::string key;
+		query_symmetry[index] = symmetry::canonical(query.position, query.current_player, &key);
+
+		const auto hit = cache.find(key);
+		if (hit != cache.end()) {
+			query_result[index] = hit->second;
+			++statistic.cache_hits;
+			continue;
+		}
+
+		const auto known = job_index.find(key);
+		if (known != job_index.end()) {
+			query_job[index] = known->second;
+			continue;
+		}
+
+		query_job[index] = jobs.size();
+		job_index.emplace(key, jobs.size());
+		jobs.push_back(job{
+			key,
+			symmetry::transform(query.position, query_symmetry[index]),
+			query.current_player,
+			cached_result()
+		});
+	}
+
+	// spread the jobs over the workers, each picking the next open job
+	std::atomic<std::size_t> next_job(0);
+	auto work = [&](unsigned worker) {
+		for(std::size_t index; (index = next_job++) < jobs.size(); ) {
+			jobs[index].result = evaluate_canonical(jobs[index].position, jobs[index].current_player, worker);
+		}
+	};
+	if (workers && 1 < jobs.size()) {
+		std::vector<std::future<void>> pending;
+		for(unsigned worker = 0; worker < searchers.size(); ++worker) {
+			pending.emplace_back(workers->submit(std::bind(work, worker)));
+		}
+		for(auto &worker : pending) {
+			worker.get();
+		}
+	}
+	else {
+		work(0);
+	}
+
+	if (config.cache_size < cache.size() + jobs.size()) {
+		cache.clear();
+	}
+	for(const auto &finished : jobs) {
+		cache.emplace(finished.key, finished.result);
+	}
+
+	std::vector<evaluation_answer> answers(batch.size());
+	for(std::size_t index = 0; index < batch.size(); ++index) {
+		const cached_result &result = (query_job[index] == cached)
+			? query_result[index]
+			: jobs[query_job[index]].result;
+
+		evaluation_answer &answer = answers[index];
+		answer.id = batch[index].id;
+		answer.result = result.valid ? evaluation_answer::status::ok : evaluation_answer::status::invalid;
+		answer.depth = result.valid ? static_cast<std::uint8_t>(result.depth) : 0;
+		answer.move = result.valid
+			? static_cast<std::uint16_t>(symmetry::transform_index(
+				batch[index].position.order(),
+				result.move,
+				symmetry::inverse(query_symmetry[index])
+			))
+			: 0;
+		answer.value = result.valid ? static_cast<std::int16_t>(result.value) : 0;
+	}
+
+	statistic.queries += batch.size();
+	statistic.evaluations += jobs.size();
+	++statistic.batches;
+	statistic.elapsed += clock_type::now() - start;
+	return answers;
+}
+
+void tictactoe::evaluation_service::run(std::istream &is, std::ostream &os) {
+	struct pending_query {
+		evaluation_query query;
+		clock_type::time_point arrival;
+	};
+
+	std::mutex mutex;
+	std::condition_variable arrived;
+	std::deque<pending_query> queue;
+	bool input_done = false;
+	std::exception_ptr input_error;
+
+	std::thread reader([&]() {
+		try {
+			evaluation_query query;
+			while(read_query(is, query)) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					queue.push_back(pending_query{query, clock_type::now()});
+				}
+				arrived.notify_one();
+			}
+		}
+		catch(...) {
+			input_error = std::current_exception();
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			input_done = true;
+		}
+		arrived.notify_one();
+	});
+
+	const clock_type::time_point start = clock_type::now();
+	const std::chrono::duration<double> evaluation_time = statistic.elapsed;
+	std::vector<evaluation_query> batch;
+	for(;;) {
+		clock_type::time_point first_arrival;
+		batch.clear();
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			arrived.wait(lock, [&]() { return input_done || !queue.empty(); });
+			if (queue.empty()) {
+				break;
+			}
+
+			// coalesce whatever arrives within the batch window
+			first_arrival = queue.front().arrival;
+			arrived.wait_until(lock, first_arrival + config.batch_window, [&]() {
+				return input_done || config.max_batch_size <= queue.size();
+			});
+
+			const std::size_t batch_size = std::min(queue.size(), config.max_batch_size);
+			batch.reserve(batch_size);
+			for(std::size_t index = 0; index < batch_size; ++index) {
+				batch.push_back(std::move(queue.front().query));
+				queue.pop_front();
+			}
+		}
+
+		for(const auto &answer : evaluate(batch)) {
+			write_answer(os, answer);
+		}
+		os.flush();
+		statistic.batch_latencies.push_back(clock_type::now() - first_arrival);
+	}
+
+	reader.join();
+	// count the wall clock time of the whole run instead of the pure
+	// evaluation time of its batches
+	statistic.elapsed = evaluation_time + (clock_type::now() - start);
+	if (input_error) {
+		std::rethrow_exception(input_error);
+	}
+}
+
+const tictactoe::evaluation_service::statistics &tictactoe::evaluation_service::stats() const {
+	return statistic;
+}
@@ -0,0 +1,189 @@
+#ifndef TICTACTOE_EVALUATION_SERVICE_HPP_INCLUDED
+#define TICTACTOE_EVALUATION_SERVICE_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "field.hpp"
+#include "searcher.hpp"
+#include "thread_pool.hpp"
+#include "transposition_table.hpp"
+
+namespace tictactoe {
+
+/**
+ * A request to evaluate a single position.
+ *
+ * Wire format (little endian):
+ *   uint32 id, uint8 order, uint8 win_length, uint8 current_player (1 or 2),
+ *   followed by ceil(order * order / 4) bytes of tiles, four tiles per byte,
+ *   the first tile in the lowest two bits (0 = empty, 1 = player 1,
+ *   2 = player 2).
+ */
+struct evaluation_query {
+	std::uint32_t id;
+	field position;
+	field::tile current_player;
+};
+
+/**
+ * The answer to an evaluation_query.
+ *
+ * Wire format (little endian):
+ *   uint32 id, uint8 status, uint8 depth, uint16 move, int16 value
+ */
+struct evaluation_answer {
+	enum class status : std::uint8_t {
+		ok,
+		/**
+		 * The position is malformed, already decided or full.
+		 */
+		invalid
+	};
+
+	std::uint32_t id;
+	status result;
+	/**
+	 * The search depth the value is based on, see search_result::depth.
+	 */
+	std::uint8_t depth;
+	std::uint16_t move;
+	/**
+	 * The value from the point of view of the player to move, see
+	 * search_result::value.
+	 */
+	std::int16_t value;
+};
+
+/**
+ * Reads a query in wire format.
+ * \return false on end of input.
+ * \throw std::runtime_error on malformed or truncated input.
+ */
+bool read_query(std::istream &is, evaluation_query &query);
+
+/**
+ * Writes a query in wire format.
+ */
+void write_query(std::ostream &os, const evaluation_query &query);
+
+/**
+ * Reads an answer in wire format.
+ * \return false on end of input.
+ * \throw std::runtime_error on truncated input.
+ */
+bool read_answer(std::istream &is, evaluation_answer &answer);
+
+/**
+ * Writes an answer in wire format.
+ */
+void write_answer(std::ostream &os, const evaluation_answer &answer);
+
+/**
+ * Evaluates batches of positions on a pool of worker threads.
+ * Within a batch, positions are folded by symmetry and evaluated once; the
+ * results are cached across batches.
+ */
+struct evaluation_service {
+	struct settings {
+		/**
+		 * Create the default settings: one worker per hardware thread,
+		 * a complete search of positions up to 4x4, one second for
+		 * larger ones and batches of up to 4096 queries collected for at
+		 * most one millisecond.
+		 */
+		settings();
+
+		unsigned threads;
+		/**
+		 * The limits for each evaluation; the deadline is ignored in favour
+		 * of position_time.
+		 */
+		search_limits limits;
+		/**
+		 * The time limit for each evaluation; zero means unlimited, except
+		 * on fields larger than 4x4, see large_field_time.
+		 */
+		std::chrono::milliseconds position_time;
+		/**
+		 * The time limit for evaluations on fields larger than 4x4 if
+		 * neither position_time nor a maximum depth is set, as complete
+		 * searches of those do not finish.
+		 */
+		std::chrono::milliseconds large_field_time;
+		std::size_t max_batch_size;
+		std::chrono::microseconds batch_window;
+		/**
+		 * The maximum number of cached results; the cache is emptied once it
+		 * is full.
+		 */
+		std::size_t cache_size;
+	};
+
+	struct statistics {
+		std::uint64_t queries;
+		std::uint64_t batches;
+		std::uint64_t evaluations;
+		std::uint64_t cache_hits;
+		std::chrono::duration<double> elapsed;
+		/**
+		 * The time from the first query of a batch arriving to the last
+		 * answer of the batch being written, one entry per batch.
+		 */
+		std::vector<std::chrono::duration<double>> batch_latencies;
+
+		double queries_per_second() const;
+
+		/**
+		 * Returns the given percentile (0 - 100) of the batch latencies.
+		 */
+		std::chrono::duration<double> batch_latency(double percentile) const;
+	};
+
+	explicit evaluation_service(const settings &service_settings = settings());
+
+	/**
+	 * Evaluates a batch of queries.
+	 * \return The answers in the order of the queries.
+	 */
+	std::vector<evaluation_answer> evaluate(const std::vector<evaluation_query> &batch);
+
+	/**
+	 * Answers queries read from is until end of input, writing the answers
+	 * to os in wire format. Queries are collected into batches by a separate
+	 * reader thread; answers of a batch are flushed together.
+	 */
+	void run(std::istream &is, std::ostream &os);
+
+	/**
+	 * Returns the statistics of all evaluations so far.
+	 */
+	const statistics &stats() const;
+
+private:
+	struct cached_result {
+		bool valid;
+		field::size_type move;
+		int value;
+		unsigned depth;
+	};
+
+	cached_result evaluate_canonical(const field &position, field::tile current_player, unsigned worker);
+
+	settings config;
+	statistics statistic;
+	transposition_table table;
+	std::vector<searcher> searchers;
+	std::unique_ptr<thread_pool> workers;
+	std::unordered_map<std::string, cached_result> cache;
+};
+
+}
+
+#endif // TICTACTOE_EVALUATION_SERVICE_HPP_INCLUDED
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "field.hpp"
+#include "tracing.hpp"
 
 namespace {
     constexpr unsigned num_digits(unsigned val) {
@@ -21,11 +22,24 @@ namespace {
 }
 
 tictactoe::field::field()
-: tiles(size(), tile::empty) {}
+: field(3) {} // Tic-Tac-Toe is a 3x3 playfield
+
+tictactoe::field::field(size_type order, size_type win_length)
+: field_order(order)
+, line_length(win_length ? win_length : order)
+, tiles(size(), tile::empty) {
+	assert(0 < order && line_length <= order);
+}
 
 tictactoe::field::field(std::initializer_list<tile> init_tiles)
-: tiles(init_tiles) {
-	// check whether the number of tiles equals the expected number
+: field_order(0)
+, line_length(0)
+, tiles(init_tiles) {
+	while(size() < tiles.size()) {
+		++field_order;
+	}
+	line_length = field_order;
+	// check whether the number of tiles is a square number
 	assert(tiles.size() == size());
 }
 
@@ -38,39 +52,41 @@ bool tictactoe::field::check_win_condition(const size_type index, tile state) co
 	// op[] checks the index and throws in case of an invalid index
 	// so from here on, index is guaranteed to be valid
 
-	// check a winning line using this->order() elements, starting with the i
-	// index passed for begin and then increasing by skip steps - this model can
-	// handle all four (see below) distinct winning conditions
-	auto check_winning_line = [this, index, state](size_type begin, const size_type skip) {
-		unsigned num_elements = order();
-		for(; num_elements--; begin += skip) {
-			if (
-				// this is the tile index that is currently checked:
-				// *assume* equality for it without checking for the actual value!
-				begin != index &&
-
-				// other tiles in the range much contain the given state
-				tiles[begin] != state
-			) {
-				return false;
-			}
+	// count the tiles in a line through index that contain the given state,
+	// starting next to index and walking in direction (dx, dy) until another
+	// state or the edge of the field is hit - the tile at index itself is
+	// *assumed* to contain the state without checking for the actual value
+	const std::ptrdiff_t
+		order = this->order(),
+		x = index % order,
+		y = index / order;
+	auto count_direction = [&](const std::ptrdiff_t dx, const std::ptrdiff_t dy) {
+		size_type count = 0;
+		for(
+			std::ptrdiff_t cx = x + dx, cy = y + dy;
+			0 <= cx && cx < order && 0 <= cy && cy < order && tiles[cy * order + cx] == state;
+			cx += dx, cy += dy
+		) {
+			++count;
 		}
-		return true;
+		return count;
+	};
+	auto check_winning_line = [&](const std::ptrdiff_t dx, const std::ptrdiff_t dy) {
+		return win_length() <= 1 + count_direction(dx, dy) + count_direction(-dx, -dy);
 	};
 
-	// possible point for optimization, however: no premature optimization!
-	// algorithmic complexity (time: O(this->order()), mem: O(1)) couldn't be
-	// improved anyway - the rest are integer arithmetic and comparisons:
-	// in any case well enough for a quick tictactoe writeup
+	// algorithmic complexity (time: O(this->win_length()), mem: O(1))
+	// couldn't be improved anyway - the rest are integer arithmetic and
+	// comparisons: in any case well enough for a quick tictactoe writeup
 	return
 		// row
-		check_winning_line(index - index % order(), 1) ||
+		check_winning_line(1, 0) ||
 		// column
-		check_winning_line(index % order(), order()) ||
+		check_winning_line(0, 1) ||
 		// diagonal (\)
-		check_winning_line(0, order() + 1) ||
+		check_winning_line(1, 1) ||
 		// diagonal (/)
-		check_winning_line(order() - 1, order() - 1);
+		check_winning_line(-1, 1);
 }
 
 void tictactoe::field::print(std::ostream &os) const {
@@ -83,6 +99,7 @@ void tictactoe::field::print(std::ostream &os) const {
 }
 
 void tictactoe::field::print(std::ostream &os, empty_tile_caption_callback on_empty) const {
+    TICTACTOE_TRACE_SPAN("field::print");
     const std::string::size_type
         caption_length = num_digits(this->size()),
         player_state_padding_length = caption_length / 2; // truncation by int division is intentional
@@ -21,14 +21,22 @@ struct field {
 	typedef storage_type::size_type size_type;
 
 	/**
-	 * Create an empty field.
+	 * Create an empty 3x3 field.
 	 */
 	field();
 
+	/**
+	 * Create an empty field of arbitrary size.
+	 * \param order The number of rows and columns.
+	 * \param win_length The number of tiles in a row needed to win; 0 means
+	 *        a full row, i.e. order.
+	 */
+	explicit field(size_type order, size_type win_length = 0);
+
 	/**
 	 * Create a field from a list of states.
 	 * \param init_tiles A list of the initial tile states; init_tiles.size()
-	 *        must be sqr(this->order())
+	 *        must be a square number. A full row is needed to win.
 	 */
 	field(std::initializer_list<tile> init_tiles);
 
@@ -50,7 +58,8 @@ struct field {
 	 * Checks whether the tile at a certain index is involved in a
 	 * winning condition.
 	 * \param index The flat index of the tile to be checked.
-	 * \return true iff the tile at index is part of a full row.
+	 * \return true iff the tile at index is part of a row of at least
+	 *         win_length() tiles.
 	 */
 	bool check_win_condition(const size_type index) const;
 
@@ -59,7 +68,8 @@ struct field {
 	 * winning condition.
 	 * \param index The flat index of the tile to be checked.
 	 * \param state The state that is supposedly played.
-	 * \return true iff the tile at index would become part of a full row.
+	 * \return true iff the tile at index would become part of a row of at
+	 *         least win_length() tiles.
 	 */
 	bool check_win_condition(const size_type index, tile state) const;
 
@@ -86,9 +96,15 @@ struct field {
 	void print(std::ostream &os, empty_tile_caption_callback callback) const;
 
 	/**
-	 * Returns the order of the field.
+	 * Returns the order of the field, i.e. the number of rows and columns.
+	 */
+	inline size_type order() const noexcept { return field_order; }
+
+	/**
+	 * Returns the number of tiles in a row (horizontal, vertical or diagonal)
+	 * needed to win.
 	 */
-	inline size_type order() const noexcept { return 3; /* Tic-Tac-Toe is a 3x3 playfield */ }
+	inline size_type win_length() const noexcept { return line_length; }
 
 	/**
 	 * Returns the total number of tiles.
@@ -101,6 +117,8 @@ struct field {
 	bool empty() const noexcept;
 
 private:
+	size_type field_order;
+	size_type line_length;
 	storage_type tiles;
 };
 
@@ -0,0 +1,139 @@
+#include "field_position.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+#include "zobrist.hpp"
+
+static_assert(std::is_trivially_copyable<tictactoe::field_position>::value,
+	"field_position has to be copyable with memcpy");
+
+constexpr tictactoe::field_position::size_type tictactoe::field_position::max_order;
+constexpr tictactoe::field_position::size_type tictactoe::field_position::max_size;
+
+tictactoe::field_position::field_position()
+: field_position(3) {}
+
+tictactoe::field_position::field_position(size_type order, size_type win_length)
+: zobrist(0)
+, num_moves(0)
+, num_empty(static_cast<std::uint16_t>(order * order))
+, field_order(static_cast<std::uint8_t>(order))
+, line_length(static_cast<std::uint8_t>(win_length ? win_length : order))
+, side(0)
+, result(status::ongoing) {
+	assert(0 < order && order <= max_order && line_length <= order);
+	std::memset(tiles, static_cast<int>(field::tile::empty), sizeof(tiles));
+}
+
+tictactoe::field_position::field_position(const field &init_tiles, field::tile current_player)
+: field_position(init_tiles.order(), init_tiles.win_length()) {
+	assert(current_player != field::tile::empty);
+	side = (current_player == field::tile::player2);
+	if (side) {
+		zobrist ^= zobrist::side_key(order(), win_length());
+	}
+
+	for(size_type index = 0; index < size(); ++index) {
+		const field::tile state = init_tiles[index];
+		if (state == field::tile::empty) {
+			continue;
+		}
+		tiles[index] = static_cast<std::uint8_t>(state);
+		zobrist ^= zobrist::tile_key(order(), win_length(), index, state);
+		--num_empty;
+	}
+
+	// a decided field stays decided
+	for(size_type index = 0; index < size() && result == status::ongoing; ++index) {
+		if ((*this)[index] != field::tile::empty && completes_line(index)) {
+			result = ((*this)[index] == field::tile::player1) ? status::player1_won : status::player2_won;
+		}
+	}
+	if (result == status::ongoing && 0 == num_empty) {
+		result = status::draw;
+	}
+}
+
+tictactoe::field tictactoe::field_position::to_field() const {
+	field result(order(), win_length());
+	for(size_type index = 0; index < size(); ++index) {
+		result[index] = (*this)[index];
+	}
+	return result;
+}
+
+bool tictactoe::field_position::is_legal(size_type index) const noexcept {
+	return
+		result == status::ongoing &&
+		index < size() &&
+		(*this)[index] == field::tile::empty;
+}
+
+void tictactoe::field_position::make_move(size_type index) noexcept {
+	make_move(index, current_player());
+}
+
+void tictactoe::field_position::make_move(size_type index, field::tile state) noexcept {
+	assert(is_legal(index) && state != field::tile::empty);
+	tiles[index] = static_cast<std::uint8_t>(state);
+	undo_stack[num_moves++] = static_cast<std::uint8_t>(index);
+	--num_empty;
+	zobrist ^=
+		zobrist::tile_key(order(), win_length(), index, state) ^
+		zobrist::side_key(order(), win_length());
+	side ^= 1;
+
+	if (completes_line(index)) {
+		result = (state == field::tile::player1) ? status::player1_won : status::player2_won;
+	}
+	else if (0 == num_empty) {
+		result = status::draw;
+	}
+}
+
+void tictactoe::field_position::unmake_move() noexcept {
+	assert(0 < num_moves);
+	const size_type index = undo_stack[--num_moves];
+
+	side ^= 1;
+	zobrist ^=
+		zobrist::tile_key(order(), win_length(), index, (*this)[index]) ^
+		zobrist::side_key(order(), win_length());
+	++num_empty;
+	tiles[index] = static_cast<std::uint8_t>(field::tile::empty);
+
+	// no move is possible after the game was decided, so it was ongoing
+	// before the move that is taken back
+	result = status::ongoing;
+}
+
+bool tictactoe::field_position::completes_line(size_type index) const noexcept {
+	// same approach as field::check_win_condition: count the tiles of the
+	// same state on both sides of index in each direction
+	const std::uint8_t state = tiles[index];
+	const int
+		order = field_order,
+		x = static_cast<int>(index) % order,
+		y = static_cast<int>(index) / order;
+	static const int directions[][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+	for(const auto &direction : directions) {
+		int length = 1;
+		for(int sign = -1; sign <= 1; sign += 2) {
+			const int dx = sign * direction[0], dy = sign * direction[1];
+			for(
+				int cx = x + dx, cy = y + dy;
+				0 <= cx && cx < order && 0 <= cy && cy < order && tiles[cy * order + cx] == state;
+				cx += dx, cy += dy
+			) {
+				++length;
+			}
+		}
+		if (line_length <= length) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,146 @@
+#ifndef TICTACTOE_FIELD_POSITION_HPP_INCLUDED
+#define TICTACTOE_FIELD_POSITION_HPP_INCLUDED
+
+#include <cstdint>
+
+#include "field.hpp"
+
+namespace tictactoe {
+
+/**
+ * A compact game position on a field of up to max_order x max_order tiles,
+ * meant for search and replay code.
+ *
+ * Unlike field, the position is trivially copyable and never allocates. Moves
+ * are applied with make_move() and taken back with unmake_move() in constant
+ * time (apart from the O(win_length) check for a win); the player to move,
+ * the game status and the Zobrist hash are updated incrementally.
+ */
+struct field_position {
+	typedef field::size_type size_type;
+
+	static constexpr size_type max_order = 16;
+	static constexpr size_type max_size = max_order * max_order;
+
+	enum class status : std::uint8_t {
+		ongoing,
+		player1_won,
+		player2_won,
+		draw
+	};
+
+	/**
+	 * Create the initial position of a classic game of tic-tac-toe.
+	 */
+	field_position();
+
+	/**
+	 * Create the initial position on an empty field of arbitrary size.
+	 * \param order The number of rows and columns; at most max_order.
+	 * \param win_length The number of tiles in a row needed to win; 0 means
+	 *        a full row.
+	 */
+	explicit field_position(size_type order, size_type win_length = 0);
+
+	/**
+	 * Create a position from the tiles of a field.
+	 * \param tiles The field; its order must not exceed max_order.
+	 * \param current_player The state of the player to move.
+	 * \note The tiles already on the field cannot be taken back.
+	 */
+	field_position(const field &tiles, field::tile current_player);
+
+	/**
+	 * Returns the tiles of the position as a field.
+	 */
+	field to_field() const;
+
+	/**
+	 * Returns the state of a tile. The index is not checked.
+	 */
+	field::tile operator[](size_type index) const noexcept { return static_cast<field::tile>(tiles[index]); }
+
+	inline size_type order() const noexcept { return field_order; }
+	inline size_type win_length() const noexcept { return line_length; }
+	inline size_type size() const noexcept { return size_type(field_order) * field_order; }
+
+	/**
+	 * Returns the state the current player plays.
+	 */
+	field::tile current_player() const noexcept { return side ? field::tile::player2 : field::tile::player1; }
+
+	/**
+	 * Returns the state the opponent plays.
+	 */
+	field::tile opponent_player() const noexcept { return side ? field::tile::player1 : field::tile::player2; }
+
+	/**
+	 * Returns whether the game is ongoing, won or drawn. A won status tells
+	 * whose state completed a line, not who won under rules other than the
+	 * standard ones, see rules.hpp.
+	 */
+	status game_status() const noexcept { return result; }
+
+	/**
+	 * Returns the number of empty tiles.
+	 */
+	size_type empty_tiles() const noexcept { return num_empty; }
+
+	/**
+	 * Returns the number of moves that can be taken back.
+	 */
+	size_type moves_played() const noexcept { return num_moves; }
+
+	/**
+	 * Returns the most recent move that can be taken back; moves_played()
+	 * must not be 0.
+	 */
+	size_type last_move() const noexcept { return undo_stack[num_moves - 1]; }
+
+	/**
+	 * Returns the Zobrist hash of the position and the player to move. It
+	 * equals searcher::hash() of the same position.
+	 */
+	std::uint64_t hash() const noexcept { return zobrist; }
+
+	/**
+	 * Returns whether the current player may play the given tile.
+	 */
+	bool is_legal(size_type index) const noexcept;
+
+	/**
+	 * Plays the current player's state on the given tile and passes the turn.
+	 * \param index The flat index of the tile; is_legal(index) must hold.
+	 */
+	void make_move(size_type index) noexcept;
+
+	/**
+	 * Plays an arbitrary state on the given tile and passes the turn, for
+	 * variants in which players may play either state, see rules.hpp.
+	 * \param index The flat index of the tile; is_legal(index) must hold.
+	 * \param state The state to play; it must not be field::tile::empty.
+	 */
+	void make_move(size_type index, field::tile state) noexcept;
+
+	/**
+	 * Takes back the most recent move; moves_played() must not be 0.
+	 */
+	void unmake_move() noexcept;
+
+private:
+	bool completes_line(size_type index) const noexcept;
+
+	std::uint8_t tiles[max_size];
+	std::uint8_t undo_stack[max_size];
+	std::uint64_t zobrist;
+	std::uint16_t num_moves;
+	std::uint16_t num_empty;
+	std::uint8_t field_order;
+	std::uint8_t line_length;
+	std::uint8_t side;
+	status result;
+};
+
+}
+
+#endif // TICTACTOE_FIELD_POSITION_HPP_INCLUDED
@@ -1,9 +1,13 @@
 #include <cassert>
 
+#include <algorithm>
 #include <iostream>
 
 #include "game.hpp"
+#include "game_observer.hpp"
 #include "player.hpp"
+#include "tracing.hpp"
+#include "watchdog.hpp"
 
 
 
@@ -32,11 +36,25 @@ namespace {
 
 namespace tictactoe {
 	struct game_state {
-		game_state()
-		: field()
+		typedef std::chrono::steady_clock clock_type;
+
+		game_state(const game_settings &settings)
+		: field(settings.order, settings.win_length)
 		, current_player(tictactoe::field::tile::player2)
+		, last_move(0)
 		, can_move(false)
-		, game_won(false) {}
+		, game_won(false)
+		, move_time(settings.move_time)
+		, game_time(settings.game_time)
+		, deadline(clock_type::time_point::max())
+		, cancelled(false)
+		, timer_armed(false) {
+			time_left[0] = time_left[1] = settings.game_time;
+		}
+
+		~game_state() {
+			disarm();
+		}
 
 		void prepare_next_move() {
 			if (can_move) {
@@ -48,9 +66,22 @@ namespace tictactoe {
 			else {
 				current_player = opponent();
 				can_move = true;
+				start_clock();
 			}
 		}
 
+		void finish_move() {
+			disarm();
+			time_left[current_player == tictactoe::field::tile::player2] -= clock_type::now() - move_start;
+			if (can_move && time_is_up()) {
+				throw time_limit_exception("You have run out of time.");
+			}
+		}
+
+		bool time_is_up() const {
+			return cancelled.load() || deadline <= clock_type::now();
+		}
+
 		tictactoe::field::tile opponent() {
 			return (current_player == tictactoe::field::tile::player1)
 				? tictactoe::field::tile::player2
@@ -59,13 +90,63 @@ namespace tictactoe {
 
 		tictactoe::field field;
 		tictactoe::field::tile current_player;
+		tictactoe::field::size_type last_move;
 		bool can_move;
 		bool game_won;
+		std::chrono::milliseconds move_time;
+		std::chrono::milliseconds game_time;
+		clock_type::duration time_left[2];
+		clock_type::time_point move_start;
+		clock_type::time_point deadline;
+		std::atomic<bool> cancelled;
+
+	private:
+		void start_clock() {
+			move_start = clock_type::now();
+			deadline = clock_type::time_point::max();
+			if (move_time.count()) {
+				deadline = move_start + move_time;
+			}
+			if (game_time.count()) {
+				deadline = std::min(deadline, move_start + time_left[current_player == tictactoe::field::tile::player2]);
+			}
+
+			// the shared watchdog raises the flag, so players don't have to
+			// read the clock themselves
+			cancelled.store(false);
+			if (deadline != clock_type::time_point::max()) {
+				timer = watchdog::shared().arm(deadline, cancelled);
+				timer_armed = true;
+			}
+		}
+
+		void disarm() {
+			if (timer_armed) {
+				watchdog::shared().disarm(timer);
+				timer_armed = false;
+			}
+		}
+
+		watchdog::timer timer;
+		bool timer_armed;
 	};
 }
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::game_settings
+//
+
+tictactoe::game_settings::game_settings()
+: order(3)
+, win_length(0)
+, move_time(0)
+, game_time(0)
+, observer(nullptr) {}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // tictactoe::game_make_move_interface
 //
@@ -82,13 +163,18 @@ void tictactoe::game_make_move_interface::make_move(tictactoe::field::size_type
 	if (!state.can_move) {
 		throw rule_violation_exception("You have already made your move.");
 	}
+	if (state.time_is_up()) {
+		throw time_limit_exception("You have run out of time.");
+	}
 	try {
-		tictactoe::field::tile &tile = state.field[transformation_func(state.field, index)];
+		const tictactoe::field::size_type field_index = transformation_func(state.field, index);
+		tictactoe::field::tile &tile = state.field[field_index];
 		if (tile != tictactoe::field::tile::empty) {
 			throw rule_violation_exception("The chosen tile is already occupied.");
 		}
 		tile = state.current_player;
-		state.game_won = state.field.check_win_condition(index);
+		state.last_move = field_index;
+		state.game_won = state.field.check_win_condition(field_index);
 		state.can_move = false;
 	}
 	catch(std::out_of_range &) {
@@ -108,6 +194,18 @@ tictactoe::field::tile tictactoe::game_make_move_interface::opponent_player() co
 	return state.opponent();
 }
 
+std::chrono::steady_clock::time_point tictactoe::game_make_move_interface::deadline() const {
+	return state.deadline;
+}
+
+bool tictactoe::game_make_move_interface::cancelled() const {
+	return state.cancelled.load(std::memory_order_relaxed);
+}
+
+const std::atomic<bool> &tictactoe::game_make_move_interface::cancellation() const {
+	return state.cancelled;
+}
+
 tictactoe::game_make_move_interface tictactoe::game_make_move_interface::transform(transformation new_transformation) const {
 	transformation current_transformation = transformation_func; // necessary to prevent capture by reference
 	return game_make_move_interface(
@@ -169,8 +267,9 @@ tictactoe::game_make_move_interface tictactoe::game_make_move_interface::mirror(
 // main game function
 //
 
-tictactoe::player *tictactoe::game(player &player1, player &player2) {
-	game_state state;
+tictactoe::player *tictactoe::game(player &player1, player &player2, const game_settings &settings, game_outcome *outcome) {
+	TICTACTOE_TRACE_SPAN("game");
+	game_state state(settings);
 
 	auto current_player = [&]() -> player& {
 		return if_tile_state(state.current_player, player1, player2);
@@ -178,13 +277,34 @@ tictactoe::player *tictactoe::game(player &player1, player &player2) {
 	auto opponent_player = [&]() -> player& {
 		return if_tile_state(state.current_player, player2, player1);
 	};
+	auto report = [&](game_outcome result) {
+		if (outcome) {
+			*outcome = result;
+		}
+	};
+	auto observe_end = [&](field::tile winner) {
+		if (settings.observer) {
+			settings.observer->end_game(winner);
+		}
+	};
+
+	if (settings.observer) {
+		settings.observer->start_game(state.field);
+	}
 
 	try {
 		field::size_type moves_left = state.field.size();
 		while(moves_left-- && !state.game_won) {
 			state.prepare_next_move();
 			std::cout << current_player().name() << ": Your turn!\n";
-			current_player().make_move(game_make_move_interface(state, identity_transformation));
+			{
+				TICTACTOE_TRACE_SPAN("make_move");
+				current_player().make_move(game_make_move_interface(state, identity_transformation));
+			}
+			state.finish_move();
+			if (settings.observer) {
+				settings.observer->move(state.field, state.last_move);
+			}
 		}
 
 		std::cout << "Game over!\n";
@@ -195,18 +315,34 @@ tictactoe::player *tictactoe::game(player &player1, player &player2) {
 			std::cout <<
 				"Congratulations, " << current_player().name() << ", you won!\n" <<
 				opponent_player().name() << ", better luck next time.\n";
+			report(game_outcome::won);
+			observe_end(state.current_player);
 			return &(current_player());
 		}
 		else {
 			std::cout <<
 				"It's a tie. Why not give it another try and play again?\n";
+			report(game_outcome::draw);
+			observe_end(field::tile::empty);
 			return nullptr;
 		}
 	}
+	catch(time_limit_exception &e) {
+		TICTACTOE_TRACE_INSTANT("time_limit_exception");
+		std::cout <<
+			current_player().name() << " has run out of time.\n"
+			"Congratulations, " << opponent_player().name() << ", you won!\n";
+		report(game_outcome::timeout);
+		observe_end(state.opponent());
+		return &(opponent_player());
+	}
 	catch(rule_violation_exception &e) {
+		TICTACTOE_TRACE_INSTANT("rule_violation_exception");
 		std::cout <<
 			current_player().name() << " has violated the rules.\n"
 			"Congratulations, " << opponent_player().name() << ", you won!\n";
+		report(game_outcome::rule_violation);
+		observe_end(state.opponent());
 		return &(opponent_player());
 	}
 	catch(...) {
@@ -1,6 +1,8 @@
 #ifndef TICTACTOE_GAME_HPP_INCLUDED
 #define TICTACTOE_GAME_HPP_INCLUDED
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <stdexcept>
 #include <string>
@@ -9,6 +11,7 @@
 
 namespace tictactoe {
 
+struct game_observer;
 struct game_state;
 struct player;
 
@@ -17,6 +20,64 @@ struct rule_violation_exception : std::runtime_error {
 	: std::runtime_error(what) {}
 };
 
+/**
+ * Thrown when a player commits a move after its deadline, see
+ * game_make_move_interface::deadline().
+ */
+struct time_limit_exception : rule_violation_exception {
+	time_limit_exception(std::string what)
+	: rule_violation_exception(what) {}
+};
+
+/**
+ * How a game has ended.
+ */
+enum class game_outcome {
+	won,
+	draw,
+	rule_violation,
+	timeout
+};
+
+/**
+ * Settings for a single match.
+ */
+struct game_settings {
+	/**
+	 * Create the settings for a classic game of tic-tac-toe without any time
+	 * limit.
+	 */
+	game_settings();
+
+	/**
+	 * The order of the field that is played on.
+	 */
+	field::size_type order;
+
+	/**
+	 * The number of tiles in a row needed to win; 0 means a full row.
+	 */
+	field::size_type win_length;
+
+	/**
+	 * The time each player has for a single move; zero means unlimited.
+	 * Players are expected to commit their move before
+	 * game_make_move_interface::deadline().
+	 */
+	std::chrono::milliseconds move_time;
+
+	/**
+	 * The time each player has for all of their moves; zero means unlimited.
+	 */
+	std::chrono::milliseconds game_time;
+
+	/**
+	 * If not nullptr, receives the start, every move and the end of the
+	 * game, e.g. a spectator_broadcaster; it has to outlive the game.
+	 */
+	game_observer *observer;
+};
+
 struct game_make_move_interface {
 	/**
 	 * Transformation callback.
@@ -47,6 +108,7 @@ struct game_make_move_interface {
 	 * given index, taking all active transformations into account.
 	 * \param index The transformed index of the tile.
 	 * \throw rule_violation_exception in case the move is illegal.
+	 * \throw time_limit_exception in case the deadline has passed.
 	 * \note You can only call this function once per game state. All
 	 *       subsequent calls will be considered a rule violation and throw an
 	 *       exception accordingly.
@@ -71,6 +133,25 @@ struct game_make_move_interface {
 	 */
 	tictactoe::field::tile opponent_player() const;
 
+	/**
+	 * Returns the point in time the current move has to be committed by, or
+	 * std::chrono::steady_clock::time_point::max() if there is no limit.
+	 */
+	std::chrono::steady_clock::time_point deadline() const;
+
+	/**
+	 * Returns whether the deadline has passed. Players should poll this
+	 * while thinking and return as soon as it is set; committing a move
+	 * after the deadline throws time_limit_exception.
+	 */
+	bool cancelled() const;
+
+	/**
+	 * Returns the flag behind cancelled(), e.g. for search_limits::stop. It
+	 * is raised by watchdog::shared() once the deadline has passed.
+	 */
+	const std::atomic<bool> &cancellation() const;
+
 	/**
 	 * Returns a copy of this interface which applies an additional
 	 * transformation, but manipulates the same game state.
@@ -102,9 +183,15 @@ private:
  * Start a game with two players.
  * \param player1 The first player. This player will have the first move.
  * \param player2 The second player.
+ * \param settings The settings for this match.
+ * \param outcome If not nullptr, receives how the game has ended. A player
+ *        that exceeds its time loses, just like for a rule violation.
  * \return A pointer to the winning player or nullptr in case of a draw.
+ * \note Time limits are enforced cooperatively: a player that neither polls
+ *       game_make_move_interface::cancelled() nor returns still blocks the
+ *       game, but loses once it returns.
  */
-player *game(player &player1, player &player2);
+player *game(player &player1, player &player2, const game_settings &settings = game_settings(), game_outcome *outcome = nullptr);
 
 }
 
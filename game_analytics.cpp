@@ -0,0 +1,391 @@
+#include "game_analytics.hpp"
+
+#include <algorithm>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#	include <fstream>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#include "field_position.hpp"
+#include "game_records.hpp"
+#include "symmetry.hpp"
+#include "thread_pool.hpp"
+#include "zobrist.hpp"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	constexpr std::size_t games_per_chunk = 1 << 16;
+	constexpr std::size_t bytes_per_chunk = 1 << 20;
+
+	// hands out chunks of whole records of a memory buffer
+	struct memory_source {
+		memory_source(const unsigned char *begin, const unsigned char *end)
+		: cursor(begin)
+		, end(end) {}
+
+		bool next(std::vector<unsigned char> & /* buffer; unused */, const unsigned char *&chunk_begin, const unsigned char *&chunk_end) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (cursor == end) {
+				return false;
+			}
+
+			// only the lengths are scanned here, the replay is left to the
+			// worker
+			const unsigned char *record = cursor;
+			for(std::size_t games = 0; games < games_per_chunk && record != end; ++games) {
+				if (end - record < 1 + *record) {
+					throw std::runtime_error("Truncated game record.");
+				}
+				record += 1 + *record;
+			}
+			chunk_begin = cursor;
+			chunk_end = cursor = record;
+			return true;
+		}
+
+		std::mutex mutex;
+		const unsigned char *cursor;
+		const unsigned char *end;
+	};
+
+	// reads chunks of whole records from a stream into the worker's buffer
+	struct stream_source {
+		stream_source(std::istream &is)
+		: is(is) {}
+
+		bool next(std::vector<unsigned char> &buffer, const unsigned char *&chunk_begin, const unsigned char *&chunk_end) {
+			std::lock_guard<std::mutex> lock(mutex);
+			buffer.clear();
+			for(int length; buffer.size() < bytes_per_chunk && std::char_traits<char>::eof() != (length = is.get()); ) {
+				const std::size_t offset = buffer.size();
+				buffer.resize(offset + 1 + length);
+				buffer[offset] = static_cast<unsigned char>(length);
+				is.read(reinterpret_cast<char *>(&buffer[offset + 1]), length);
+				if (is.gcount() != length) {
+					throw std::runtime_error("Truncated game record.");
+				}
+			}
+			chunk_begin = buffer.data();
+			chunk_end = buffer.data() + buffer.size();
+			return !buffer.empty();
+		}
+
+		std::mutex mutex;
+		std::istream &is;
+	};
+
+	template<typename source_type>
+	tictactoe::game_statistics analyze(
+		source_type &source,
+		tictactoe::field::size_type order,
+		tictactoe::field::size_type win_length,
+		unsigned threads,
+		tictactoe::field::size_type opening_depth
+	) {
+		const clock_type::time_point start = clock_type::now();
+		if (0 == threads) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		// map: every worker aggregates into its own statistics
+		std::vector<tictactoe::game_statistics> partial(
+			threads,
+			tictactoe::game_statistics(order, win_length, opening_depth)
+		);
+		auto work = [&](unsigned worker) {
+			std::vector<unsigned char> buffer;
+			const unsigned char *chunk_begin, *chunk_end;
+			while(source.next(buffer, chunk_begin, chunk_end)) {
+				for(const unsigned char *record = chunk_begin; record != chunk_end; record += 1 + *record) {
+					partial[worker].add_game(record + 1, *record);
+				}
+			}
+		};
+
+		{
+			tictactoe::thread_pool workers(threads);
+			std::vector<std::future<void>> pending;
+			for(unsigned worker = 0; worker < threads; ++worker) {
+				pending.emplace_back(workers.submit(std::bind(work, worker)));
+			}
+			for(auto &worker : pending) {
+				worker.get();
+			}
+		}
+
+		// reduce
+		for(unsigned worker = 1; worker < threads; ++worker) {
+			partial[0].merge(partial[worker]);
+		}
+		partial[0].elapsed = clock_type::now() - start;
+		return partial[0];
+	}
+
+	void print_percent(std::ostream &os, std::uint64_t part, std::uint64_t total) {
+		os << std::setw(5) << std::fixed << std::setprecision(1) << (total ? 100.0 * part / total : 0.0) << '%';
+	}
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::game_statistics
+//
+
+void tictactoe::game_statistics::outcomes::merge(const outcomes &other) {
+	games += other.games;
+	player1_wins += other.player1_wins;
+	player2_wins += other.player2_wins;
+	draws += other.draws;
+}
+
+tictactoe::game_statistics::game_statistics(field::size_type order, field::size_type win_length, field::size_type opening_depth)
+: order(order)
+, win_length(win_length)
+, opening_depth(opening_depth)
+, results()
+, corrupt_games(0)
+, moves(0)
+, first_moves(order * order, outcomes())
+, elapsed(0) {
+	const field::tile players[] = { field::tile::player1, field::tile::player2 };
+	for(unsigned player = 0; player < 2; ++player) {
+		heatmap[player].assign(order * order, 0);
+		symmetric_keys[player].resize(symmetry::count * order * order);
+		for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+			for(field::size_type index = 0; index < order * order; ++index) {
+				symmetric_keys[player][transformation * order * order + index] = zobrist::tile_key(
+					order, win_length,
+					symmetry::transform_index(order, index, transformation),
+					players[player]
+				);
+			}
+		}
+	}
+}
+
+void tictactoe::game_statistics::add_game(const std::uint8_t *game_moves, field::size_type num_moves) {
+	const field::size_type size = order * order;
+	const field::size_type num_openings = std::min(num_moves, opening_depth);
+	std::uint64_t opening_keys[field_position::max_size];
+
+	// replay first, so corrupt games don't leave traces in the statistics
+	field_position position(order, win_length);
+	std::uint64_t hashes[symmetry::count] = {};
+	for(field::size_type ply = 0; ply < num_moves; ++ply) {
+		const field::size_type move = game_moves[ply];
+		if (!position.is_legal(move)) {
+			++corrupt_games;
+			return;
+		}
+		position.make_move(move);
+
+		if (ply < num_openings) {
+			std::uint64_t canonical = ~std::uint64_t(0);
+			for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+				hashes[transformation] ^= symmetric_keys[ply % 2][transformation * size + move];
+				canonical = std::min(canonical, hashes[transformation]);
+			}
+			opening_keys[ply] = canonical;
+		}
+	}
+
+	outcomes result = {1, 0, 0, 0};
+	switch(position.game_status()) {
+	case field_position::status::ongoing:
+		break; // unfinished games only count as games
+	case field_position::status::player1_won:
+		result.player1_wins = 1;
+		break;
+	case field_position::status::player2_won:
+		result.player2_wins = 1;
+		break;
+	case field_position::status::draw:
+		result.draws = 1;
+		break;
+	}
+
+	results.merge(result);
+	moves += num_moves;
+	for(field::size_type ply = 0; ply < num_moves; ++ply) {
+		++heatmap[ply % 2][game_moves[ply]];
+	}
+	if (0 < num_moves) {
+		first_moves[game_moves[0]].merge(result);
+	}
+	for(field::size_type ply = 0; ply < num_openings; ++ply) {
+		opening &entry = openings[opening_keys[ply]];
+		if (entry.line.empty()) {
+			entry.line.assign(game_moves, game_moves + ply + 1);
+		}
+		entry.results.merge(result);
+	}
+}
+
+void tictactoe::game_statistics::merge(const game_statistics &other) {
+	results.merge(other.results);
+	corrupt_games += other.corrupt_games;
+	moves += other.moves;
+	for(unsigned player = 0; player < 2; ++player) {
+		for(field::size_type index = 0; index < heatmap[player].size(); ++index) {
+			heatmap[player][index] += other.heatmap[player][index];
+		}
+	}
+	for(field::size_type index = 0; index < first_moves.size(); ++index) {
+		first_moves[index].merge(other.first_moves[index]);
+	}
+	for(const auto &entry : other.openings) {
+		opening &merged = openings[entry.first];
+		if (merged.line.empty()) {
+			merged.line = entry.second.line;
+		}
+		merged.results.merge(entry.second.results);
+	}
+}
+
+void tictactoe::game_statistics::print(std::ostream &os, std::size_t max_openings) const {
+	const std::ios::fmtflags flags = os.flags();
+	const std::uint64_t games = results.games;
+
+	os <<
+		"Games: " << games << " (" << corrupt_games << " corrupt), " <<
+		moves << " moves, " << static_cast<std::uint64_t>(elapsed.count() > 0 ? games / elapsed.count() : 0) << " games/s\n"
+		"Results: player 1 ";
+	print_percent(os, results.player1_wins, games);
+	os << ", player 2 ";
+	print_percent(os, results.player2_wins, games);
+	os << ", draw ";
+	print_percent(os, results.draws, games);
+	os << "\n";
+
+	const char * const player_names[] = { "player 1", "player 2" };
+	for(unsigned player = 0; player < 2; ++player) {
+		os << "\nMove heatmap for " << player_names[player] << " (moves per game):";
+		for(field::size_type index = 0; index < heatmap[player].size(); ++index) {
+			os << ((0 == index % order) ? "\n  " : " ");
+			os << std::setw(5) << std::fixed << std::setprecision(3) << (games ? 1.0 * heatmap[player][index] / games : 0.0);
+		}
+		os << '\n';
+	}
+
+	os << "\nResults by first move (games, player 1 / draw / player 2):\n";
+	for(field::size_type index = 0; index < first_moves.size(); ++index) {
+		const outcomes &entry = first_moves[index];
+		if (0 == entry.games) {
+			continue;
+		}
+		os << "  " << std::setw(3) << index << ": " << std::setw(10) << entry.games << "  ";
+		print_percent(os, entry.player1_wins, entry.games);
+		os << " / ";
+		print_percent(os, entry.draws, entry.games);
+		os << " / ";
+		print_percent(os, entry.player2_wins, entry.games);
+		os << '\n';
+	}
+
+	std::vector<const opening *> sorted;
+	sorted.reserve(openings.size());
+	for(const auto &entry : openings) {
+		sorted.push_back(&entry.second);
+	}
+	const std::size_t num_printed = std::min(max_openings, sorted.size());
+	std::partial_sort(sorted.begin(), sorted.begin() + num_printed, sorted.end(), [](const opening *lhs, const opening *rhs) {
+		return lhs->results.games > rhs->results.games ||
+			(lhs->results.games == rhs->results.games && lhs->line < rhs->line);
+	});
+
+	os <<
+		"\nMost frequent positions up to move " << opening_depth << ", folded by symmetry (" <<
+		openings.size() << " distinct; games, player 1 / draw / player 2):\n";
+	for(std::size_t index = 0; index < num_printed; ++index) {
+		const opening &entry = *sorted[index];
+		std::string line;
+		for(const std::uint8_t move : entry.line) {
+			line += (line.empty() ? "" : " ") + std::to_string(move);
+		}
+		os << "  " << std::left << std::setw(3 * opening_depth) << line << std::right << std::setw(10) << entry.results.games << "  ";
+		print_percent(os, entry.results.player1_wins, entry.results.games);
+		os << " / ";
+		print_percent(os, entry.results.draws, entry.results.games);
+		os << " / ";
+		print_percent(os, entry.results.player2_wins, entry.results.games);
+		os << '\n';
+	}
+
+	os.flags(flags);
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// analyze_game_records
+//
+
+tictactoe::game_statistics tictactoe::analyze_game_records(const unsigned char *data, std::size_t size, unsigned threads, field::size_type opening_depth) {
+	field::size_type order, win_length;
+	if (!game_records::read_header(data, size, order, win_length)) {
+		throw std::runtime_error("Invalid game record header.");
+	}
+	memory_source source(data + game_records::header_size, data + size);
+	return analyze(source, order, win_length, threads, opening_depth);
+}
+
+tictactoe::game_statistics tictactoe::analyze_game_records(const std::string &path, unsigned threads, field::size_type opening_depth) {
+#ifdef _WIN32
+	// Workaround for Windows: no mmap, so read the file as a stream instead
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Cannot open " + path + ".");
+	}
+	return analyze_game_records(file, threads, opening_depth);
+#else
+	const int fd = open(path.c_str(), O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) < 0) {
+		if (0 <= fd) {
+			close(fd);
+		}
+		throw std::runtime_error("Cannot open " + path + ".");
+	}
+	const std::size_t size = static_cast<std::size_t>(info.st_size);
+	void * const data = size
+		? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)
+		: MAP_FAILED;
+	close(fd);
+	if (MAP_FAILED == data) {
+		throw std::runtime_error("Cannot map " + path + ".");
+	}
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	try {
+		game_statistics result = analyze_game_records(static_cast<const unsigned char *>(data), size, threads, opening_depth);
+		munmap(data, size);
+		return result;
+	}
+	catch(...) {
+		munmap(data, size);
+		throw;
+	}
+#endif
+}
+
+tictactoe::game_statistics tictactoe::analyze_game_records(std::istream &is, unsigned threads, field::size_type opening_depth) {
+	field::size_type order, win_length;
+	if (!game_records::read_header(is, order, win_length)) {
+		throw std::runtime_error("Invalid game record header.");
+	}
+	stream_source source(is);
+	return analyze(source, order, win_length, threads, opening_depth);
+}
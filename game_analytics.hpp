@@ -0,0 +1,125 @@
+#ifndef TICTACTOE_GAME_ANALYTICS_HPP_INCLUDED
+#define TICTACTOE_GAME_ANALYTICS_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "field.hpp"
+
+namespace tictactoe {
+
+/**
+ * Statistics over a set of game records, see game_records.hpp.
+ * Each worker thread aggregates into its own instance; the instances are
+ * merged at the end.
+ */
+struct game_statistics {
+	struct outcomes {
+		std::uint64_t games;
+		std::uint64_t player1_wins;
+		std::uint64_t player2_wins;
+		std::uint64_t draws;
+
+		void merge(const outcomes &other);
+	};
+
+	struct opening {
+		outcomes results;
+		/**
+		 * The first line of play seen reaching this position.
+		 */
+		std::vector<std::uint8_t> line;
+	};
+
+	/**
+	 * Create empty statistics.
+	 * \param order The order of the recorded games' field.
+	 * \param win_length The win length of the recorded games.
+	 * \param opening_depth The number of moves up to which positions are
+	 *        counted as openings.
+	 */
+	game_statistics(field::size_type order, field::size_type win_length, field::size_type opening_depth);
+
+	/**
+	 * Replays a game and adds it to the statistics.
+	 * Games with illegal moves or moves after the game was decided are only
+	 * counted as corrupt.
+	 */
+	void add_game(const std::uint8_t *moves, field::size_type num_moves);
+
+	/**
+	 * Adds all games of other to these statistics.
+	 */
+	void merge(const game_statistics &other);
+
+	/**
+	 * Prints a compact summary.
+	 * \param max_openings The number of most frequent openings to print.
+	 */
+	void print(std::ostream &os, std::size_t max_openings = 20) const;
+
+	field::size_type order;
+	field::size_type win_length;
+	field::size_type opening_depth;
+
+	outcomes results;
+	std::uint64_t corrupt_games;
+	std::uint64_t moves;
+	/**
+	 * The number of moves per tile, one heatmap per player.
+	 */
+	std::vector<std::uint64_t> heatmap[2];
+	/**
+	 * The results by the tile of the first move.
+	 */
+	std::vector<outcomes> first_moves;
+	/**
+	 * The results by position up to opening_depth, folded by symmetry and
+	 * keyed by the smallest Zobrist hash of the position's symmetries.
+	 */
+	std::unordered_map<std::uint64_t, opening> openings;
+	/**
+	 * The wall clock time spent analysing.
+	 */
+	std::chrono::duration<double> elapsed;
+
+private:
+	// Zobrist keys of each tile under each of the eight symmetries
+	std::vector<std::uint64_t> symmetric_keys[2];
+};
+
+/**
+ * Analyses the game records of a memory buffer, see game_records.hpp.
+ * \param data The records, including the header.
+ * \param threads The number of worker threads; 0 uses one per hardware
+ *        thread.
+ * \param opening_depth See game_statistics.
+ * \throw std::runtime_error if the header is invalid or the last record is
+ *        truncated.
+ */
+game_statistics analyze_game_records(const unsigned char *data, std::size_t size, unsigned threads, field::size_type opening_depth);
+
+/**
+ * Analyses a file of game records. The file is mapped into memory, so the
+ * operating system only keeps the parts in memory that are being replayed.
+ * \throw std::runtime_error if the file cannot be read, see also
+ *        analyze_game_records(const unsigned char *, std::size_t, unsigned, field::size_type).
+ */
+game_statistics analyze_game_records(const std::string &path, unsigned threads, field::size_type opening_depth);
+
+/**
+ * Analyses a stream of game records, e.g. from a pipe. Workers read the
+ * stream in chunks of about a megabyte each.
+ * \throw std::runtime_error if the header is invalid or the last record is
+ *        truncated.
+ */
+game_statistics analyze_game_records(std::istream &is, unsigned threads, field::size_type opening_depth);
+
+}
+
+#endif // TICTACTOE_GAME_ANALYTICS_HPP_INCLUDED
@@ -0,0 +1,36 @@
+#ifndef TICTACTOE_GAME_OBSERVER_HPP_INCLUDED
+#define TICTACTOE_GAME_OBSERVER_HPP_INCLUDED
+
+#include "field.hpp"
+
+namespace tictactoe {
+
+/**
+ * Follows the games played by tictactoe::game(), see game_settings::observer.
+ */
+struct game_observer {
+	virtual ~game_observer() = default;
+
+	/**
+	 * Called at the start of a game.
+	 * \param position The empty field.
+	 */
+	virtual void start_game(const field &position) = 0;
+
+	/**
+	 * Called after every move.
+	 * \param position The field after the move.
+	 * \param index The flat index of the tile played.
+	 */
+	virtual void move(const field &position, field::size_type index) = 0;
+
+	/**
+	 * Called at the end of a game.
+	 * \param winner The winning player or empty for a draw.
+	 */
+	virtual void end_game(field::tile winner) = 0;
+};
+
+}
+
+#endif // TICTACTOE_GAME_OBSERVER_HPP_INCLUDED
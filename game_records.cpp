@@ -0,0 +1,40 @@
+#include "game_records.hpp"
+
+#include <cassert>
+#include <cstring>
+
+namespace {
+	const char magic[] = { 'T', 'T', 'T', 'R' };
+}
+
+void tictactoe::game_records::write_header(std::ostream &os, field::size_type order, field::size_type win_length) {
+	assert(0 < order && order <= max_order && win_length <= order);
+	os.write(magic, sizeof(magic));
+	os.put(static_cast<char>(order));
+	os.put(static_cast<char>(win_length ? win_length : order));
+}
+
+void tictactoe::game_records::write_game(std::ostream &os, const field::size_type *moves, field::size_type num_moves) {
+	assert(num_moves <= 0xff);
+	os.put(static_cast<char>(num_moves));
+	for(field::size_type index = 0; index < num_moves; ++index) {
+		os.put(static_cast<char>(moves[index]));
+	}
+}
+
+bool tictactoe::game_records::read_header(const unsigned char *data, std::size_t size, field::size_type &order, field::size_type &win_length) {
+	if (size < header_size || 0 != std::memcmp(data, magic, sizeof(magic))) {
+		return false;
+	}
+	order = data[4];
+	win_length = data[5];
+	return 0 < order && order <= max_order && 0 < win_length && win_length <= order;
+}
+
+bool tictactoe::game_records::read_header(std::istream &is, field::size_type &order, field::size_type &win_length) {
+	unsigned char header[header_size];
+	is.read(reinterpret_cast<char *>(header), header_size);
+	return
+		static_cast<std::size_t>(is.gcount()) == header_size &&
+		read_header(header, header_size, order, win_length);
+}
@@ -0,0 +1,50 @@
+#ifndef TICTACTOE_GAME_RECORDS_HPP_INCLUDED
+#define TICTACTOE_GAME_RECORDS_HPP_INCLUDED
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "field.hpp"
+
+namespace tictactoe {
+/**
+ * Game records store games as flat move sequences, compact enough to keep
+ * billions of games on disk.
+ *
+ * Layout: the magic bytes "TTTR", uint8 order, uint8 win_length, followed by
+ * one record per game: uint8 num_moves and num_moves uint8 flat tile
+ * indices in the order they were played, starting with player 1.
+ * The order is limited to 15, so that every game fits a record.
+ */
+namespace game_records {
+	constexpr std::size_t header_size = 6;
+	constexpr field::size_type max_order = 15;
+
+	/**
+	 * Writes the header of a record file.
+	 */
+	void write_header(std::ostream &os, field::size_type order, field::size_type win_length);
+
+	/**
+	 * Writes a single game.
+	 * \param moves The flat tile indices of the moves.
+	 * \param num_moves The number of moves; at most 255.
+	 */
+	void write_game(std::ostream &os, const field::size_type *moves, field::size_type num_moves);
+
+	/**
+	 * Parses the header of a record file.
+	 * \return false if the data does not start with a valid header.
+	 */
+	bool read_header(const unsigned char *data, std::size_t size, field::size_type &order, field::size_type &win_length);
+
+	/**
+	 * Reads and parses the header of a record file.
+	 * \return false if the stream does not start with a valid header.
+	 */
+	bool read_header(std::istream &is, field::size_type &order, field::size_type &win_length);
+}
+}
+
+#endif // TICTACTOE_GAME_RECORDS_HPP_INCLUDED
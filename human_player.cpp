@@ -1,5 +1,6 @@
 #include "human_player.hpp"
 
+#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <ostream>
@@ -33,6 +34,11 @@ void tictactoe::human_player::make_move(game_make_move_interface game) {
 		}
 	);
 
+	if (game.deadline() != std::chrono::steady_clock::time_point::max()) {
+		const auto time_left = std::chrono::duration_cast<std::chrono::milliseconds>(game.deadline() - std::chrono::steady_clock::now());
+		std::cout << "\nYou have " << (time_left.count() / 1000.0) << " seconds for this move.";
+	}
+
 	field::size_type index;
 	while(std::cin) {
 		try {
@@ -55,6 +61,9 @@ void tictactoe::human_player::make_move(game_make_move_interface game) {
 				std::cout << "That's not a valid tile number ... try again." << std::endl;
 			}
 		}
+		catch(time_limit_exception &) {
+			throw; // trying again won't help
+		}
 		catch(rule_violation_exception &e) {
 			std::cout << e.what() << "\nTry again." << std::endl;
 		}
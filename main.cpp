@@ -1,34 +1,254 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+#ifndef _WIN32
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
 
 #include "computer_player.hpp"
 #include "game.hpp"
 #include "human_player.hpp"
+#include "spectator.hpp"
+#include "tracing.hpp"
+#include "ultimate_computer_player.hpp"
+#include "ultimate_game.hpp"
+#include "ultimate_human_player.hpp"
 
 using namespace tictactoe;
 
 std::unique_ptr<player> make_player(std::string name) {
 	return ("cpu" == name)
-		? std::unique_ptr<player>(new computer_player())
+		? std::unique_ptr<player>(new computer_player(std::chrono::milliseconds(1000), 0))
 		: std::unique_ptr<player>(new human_player(name));
 }
 
+std::unique_ptr<ultimate_player> make_ultimate_player(std::string name) {
+	return ("cpu" == name)
+		? std::unique_ptr<ultimate_player>(new ultimate_computer_player())
+		: std::unique_ptr<ultimate_player>(new ultimate_human_player(name));
+}
+
+#ifndef _WIN32
+/**
+ * Reads from a socket, for parsing spectator frames as they arrive.
+ */
+struct socket_streambuf : std::streambuf {
+	explicit socket_streambuf(int socket)
+	: socket(socket) {}
+
+	int_type underflow() override {
+		ssize_t received;
+		while((received = read(socket, buffer, sizeof(buffer))) < 0 && EINTR == errno) {}
+		if (received <= 0) {
+			return traits_type::eof();
+		}
+		setg(buffer, buffer, buffer + received);
+		return traits_type::to_int_type(*gptr());
+	}
+
+	int socket;
+	char buffer[4096];
+};
+
+/**
+ * Watches the games broadcast on a Unix domain socket until it is closed.
+ */
+int spectate(const std::string &path) {
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	const int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket < 0 || connect(socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address))) {
+		std::cerr << "Error: Cannot connect to " << path << ": " << std::strerror(errno) << '\n';
+		if (0 <= socket) {
+			close(socket);
+		}
+		return 1;
+	}
+
+	socket_streambuf buffer(socket);
+	std::istream frames(&buffer);
+	spectator_view view;
+	try {
+		while(read_spectator_frame(frames, view)) {
+			if (view.game_over) {
+				std::cout << (
+					(view.winner == field::tile::player1) ? "Player 1 has won.\n\n" :
+					(view.winner == field::tile::player2) ? "Player 2 has won.\n\n" :
+					"It's a tie.\n\n"
+				);
+			}
+			else {
+				view.position.print(std::cout);
+				std::cout << '\n';
+			}
+		}
+	}
+	catch(std::runtime_error &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		close(socket);
+		return 1;
+	}
+	close(socket);
+	return 0;
+}
+#endif
+
 int main(int argc, const char * const argv[]) {
-	if (argc < 3) {
+	game_settings settings;
+	bool ultimate = false, valid_options = true;
+	std::string trace_path, spectators_path, spectate_path;
+	unsigned long trace_percent = 100;
+
+	int first_player_arg = 1;
+	for(; first_player_arg < argc && '-' == argv[first_player_arg][0]; ++first_player_arg) {
+		const std::string option(argv[first_player_arg]);
+		std::stringstream value((first_player_arg + 1 < argc) ? argv[first_player_arg + 1] : "");
+		unsigned long number = 0;
+
+		if ("--ultimate" == option) {
+			ultimate = true;
+			continue;
+		}
+		else if ("--trace" == option && first_player_arg + 1 < argc) {
+			trace_path = argv[first_player_arg + 1];
+		}
+#ifndef _WIN32
+		else if ("--spectators" == option && first_player_arg + 1 < argc) {
+			spectators_path = argv[first_player_arg + 1];
+		}
+		else if ("--spectate" == option && first_player_arg + 1 < argc) {
+			spectate_path = argv[first_player_arg + 1];
+		}
+#endif
+		else if (!(value >> number)) {
+			valid_options = false;
+		}
+		else if ("--order" == option && 0 < number) {
+			settings.order = number;
+		}
+		else if ("--win-length" == option) {
+			settings.win_length = number;
+		}
+		else if ("--move-time" == option) {
+			settings.move_time = std::chrono::milliseconds(number);
+		}
+		else if ("--game-time" == option) {
+			settings.game_time = std::chrono::milliseconds(number);
+		}
+		else if ("--trace-rate" == option && 0 < number && number <= 100) {
+			trace_percent = number;
+		}
+		else {
+			valid_options = false;
+		}
+		++first_player_arg; // skip the value
+	}
+	valid_options = valid_options && settings.win_length <= settings.order;
+
+#ifndef _WIN32
+	if (valid_options && !spectate_path.empty()) {
+		return spectate(spectate_path);
+	}
+#endif
+
+	if (!valid_options || argc < first_player_arg + 2) {
 		std::cerr <<
 			"Usage:\n"
-			"\t" << argv[0] << " <player1> <player2>\n"
+			"\t" << argv[0] << " [<options>] <player1> <player2>\n"
+			"\n"
+			"--ultimate\n"
+			"\tPlay ultimate tic-tac-toe: nine boards, where each move\n"
+			"\tselects the board the opponent has to play on next.\n"
+			"--order <n>\n"
+			"\tPlay on a field of n by n tiles (default: 3).\n"
+			"--win-length <k>\n"
+			"\tThe number of tiles in a row needed to win (default: a full row).\n"
+			"--move-time <ms>\n"
+			"\tThe time limit for each move in milliseconds (default: none).\n"
+			"--game-time <ms>\n"
+			"\tThe time limit for all moves of a player in milliseconds\n"
+			"\t(default: none). Players running out of time lose.\n"
+			"--trace <file>\n"
+			"\tWrite the time spent in games, moves and searches to a file in\n"
+			"\tthe Chrome trace format, for chrome://tracing or Perfetto.\n"
+			"--trace-rate <percent>\n"
+			"\tThe share of games, moves and searches traced (default: 100).\n"
+#ifndef _WIN32
+			"--spectators <socket>\n"
+			"\tBroadcast the game to spectators connecting to a Unix domain\n"
+			"\tsocket at the given path.\n"
+			"--spectate <socket>\n"
+			"\tWatch the games broadcast at the given path instead of playing.\n"
+#endif
 			"\n"
 			"<player1>, <player2>\n"
 			"\tThe names for the respective players.\n"
 			"\tTo play against the computer, use the name \"cpu\".\n";
 	}
 	else {
-		std::unique_ptr<player>
-			player1(make_player(argv[1])),
-			player2(make_player(argv[2]));
+		if (!trace_path.empty()) {
+			tracing::start(trace_percent / 100.0);
+		}
+		if (ultimate) {
+			std::unique_ptr<ultimate_player>
+				player1(make_ultimate_player(argv[first_player_arg])),
+				player2(make_ultimate_player(argv[first_player_arg + 1]));
+
+			ultimate_game(*player1, *player2);
+		}
+		else {
+			std::unique_ptr<player>
+				player1(make_player(argv[first_player_arg])),
+				player2(make_player(argv[first_player_arg + 1]));
+
+#ifndef _WIN32
+			std::unique_ptr<spectator_broadcaster> spectators;
+			if (!spectators_path.empty()) {
+				spectators.reset(new spectator_broadcaster());
+				try {
+					spectators->listen(spectators_path);
+				}
+				catch(std::runtime_error &e) {
+					std::cerr << "Error: " << e.what() << '\n';
+					return 1;
+				}
+				settings.observer = spectators.get();
+			}
+#endif
+
+			game(*player1, *player2, settings);
+
+#ifndef _WIN32
+			// give the spectators a moment to see the end of the game
+			if (spectators) {
+				spectators->flush(std::chrono::seconds(1));
+				unlink(spectators_path.c_str());
+			}
+#endif
+		}
 
-		game(*player1, *player2);
+		if (!trace_path.empty()) {
+			tracing::stop();
+			std::ofstream trace(trace_path);
+			tracing::write_chrome_trace(trace);
+			if (!trace) {
+				std::cerr << "Error: Cannot write " << trace_path << ".\n";
+				return 1;
+			}
+		}
 	}
 
 	return 0;
@@ -0,0 +1,69 @@
+#include "parallel_searcher.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+
+#include "tracing.hpp"
+
+template<typename rules_type>
+tictactoe::basic_parallel_searcher<rules_type>::basic_parallel_searcher(transposition_table &table, unsigned threads) {
+	if (0 == threads) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	searchers.reserve(threads);
+	for(unsigned index = 0; index < threads; ++index) {
+		searchers.emplace_back(table);
+	}
+	if (1 < threads) {
+		helpers.reset(new thread_pool(threads - 1));
+	}
+}
+
+template<typename rules_type>
+tictactoe::search_result tictactoe::basic_parallel_searcher<rules_type>::search(const field &position, field::tile current_player, const search_limits &limits) {
+	TICTACTOE_TRACE_SPAN("parallel_searcher::search");
+	if (!helpers) {
+		return searchers[0].search(position, current_player, limits);
+	}
+
+	std::atomic<bool> stop_helpers(false);
+	std::vector<search_result> helper_results(searchers.size() - 1);
+	std::vector<std::future<void>> pending;
+	pending.reserve(helper_results.size());
+	for(std::size_t index = 1; index < searchers.size(); ++index) {
+		search_limits helper_limits(limits);
+		helper_limits.start_depth = limits.start_depth + index % 2;
+		helper_limits.stop = &stop_helpers;
+		pending.emplace_back(helpers->submit([this, &position, current_player, helper_limits, &helper_results, index]() {
+			helper_results[index - 1] = searchers[index].search(position, current_player, helper_limits);
+		}));
+	}
+
+	search_result result;
+	try {
+		result = searchers[0].search(position, current_player, limits);
+	}
+	catch(...) {
+		stop_helpers = true;
+		for(auto &helper : pending) {
+			helper.wait();
+		}
+		throw;
+	}
+
+	stop_helpers = true;
+	TICTACTOE_TRACE_SPAN("parallel_searcher::join");
+	for(auto &helper : pending) {
+		helper.get();
+	}
+	for(const auto &helper_result : helper_results) {
+		result.nodes += helper_result.nodes;
+	}
+	return result;
+}
+
+template struct tictactoe::basic_parallel_searcher<tictactoe::rules::standard>;
+template struct tictactoe::basic_parallel_searcher<tictactoe::rules::misere>;
+template struct tictactoe::basic_parallel_searcher<tictactoe::rules::wild>;
+template struct tictactoe::basic_parallel_searcher<tictactoe::rules::order_and_chaos>;
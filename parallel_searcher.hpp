@@ -0,0 +1,52 @@
+#ifndef TICTACTOE_PARALLEL_SEARCHER_HPP_INCLUDED
+#define TICTACTOE_PARALLEL_SEARCHER_HPP_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "searcher.hpp"
+#include "thread_pool.hpp"
+
+namespace tictactoe {
+
+/**
+ * Runs a searcher per thread on the same position (Lazy SMP). The threads
+ * only cooperate through the shared transposition table; every other helper
+ * thread starts one ply deeper so the threads spread out over the tree.
+ * The main search runs on the calling thread, and its result is returned.
+ * Like basic_searcher, it is a template over the rules, see rules.hpp.
+ */
+template<typename rules_type>
+struct basic_parallel_searcher {
+	/**
+	 * Create a parallel searcher.
+	 * \param table The table shared by all threads.
+	 * \param threads The total number of search threads; 0 uses one thread
+	 *        per hardware thread. A single thread searches without any
+	 *        helpers, so its results are deterministic.
+	 */
+	basic_parallel_searcher(transposition_table &table, unsigned threads);
+
+	/**
+	 * Searches the best move, see basic_searcher::search(). Helpers are cancelled
+	 * once the main search finishes, is cancelled through limits.stop or
+	 * reaches limits.deadline.
+	 * \note The nodes of the result include the nodes of all threads.
+	 */
+	search_result search(const field &position, field::tile current_player, const search_limits &limits);
+
+	/**
+	 * Returns the total number of search threads.
+	 */
+	unsigned threads() const noexcept { return static_cast<unsigned>(searchers.size()); }
+
+private:
+	std::vector<basic_searcher<rules_type>> searchers;
+	std::unique_ptr<thread_pool> helpers;
+};
+
+typedef basic_parallel_searcher<rules::standard> parallel_searcher;
+
+}
+
+#endif // TICTACTOE_PARALLEL_SEARCHER_HPP_INCLUDED
@@ -0,0 +1,211 @@
+#include "pattern_evaluator.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+
+#include "searcher.hpp"
+
+namespace {
+	typedef tictactoe::field::size_type size_type;
+
+	// tiles at most this many rows or columns away from a played tile are
+	// candidate moves
+	constexpr int neighbourhood = 2;
+}
+
+tictactoe::pattern_evaluator::pattern_evaluator()
+: pattern_evaluator(field_position()) {}
+
+tictactoe::pattern_evaluator::pattern_evaluator(const field_position &position)
+: field_order(0)
+, line_length(0) {
+	reset(position);
+}
+
+void tictactoe::pattern_evaluator::reset(const field_position &position) {
+	const size_type size = position.size();
+
+	if (field_order != position.order() || line_length != position.win_length()) {
+		field_order = position.order();
+		line_length = position.win_length();
+
+		const int order = static_cast<int>(field_order), length = static_cast<int>(line_length);
+		static const int directions[][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+		window_start.clear();
+		window_step.clear();
+		std::vector<std::vector<std::uint16_t>> windows_by_tile(size);
+		for(int y = 0; y < order; ++y) {
+			for(int x = 0; x < order; ++x) {
+				for(const auto &direction : directions) {
+					const int
+						end_x = x + (length - 1) * direction[0],
+						end_y = y + (length - 1) * direction[1];
+					if (end_x < 0 || order <= end_x || order <= end_y) {
+						continue;
+					}
+
+					const std::int16_t step = static_cast<std::int16_t>(direction[1] * order + direction[0]);
+					const std::uint16_t window = static_cast<std::uint16_t>(window_start.size());
+					window_start.push_back(static_cast<std::uint16_t>(y * order + x));
+					window_step.push_back(step);
+					for(int offset = 0; offset < length; ++offset) {
+						windows_by_tile[y * order + x + offset * step].push_back(window);
+					}
+				}
+			}
+		}
+
+		tile_windows_begin.assign(1, 0);
+		tile_windows.clear();
+		for(const auto &windows : windows_by_tile) {
+			tile_windows.insert(tile_windows.end(), windows.begin(), windows.end());
+			tile_windows_begin.push_back(static_cast<std::uint16_t>(tile_windows.size()));
+		}
+	}
+
+	tiles.assign(size, static_cast<std::uint8_t>(field::tile::empty));
+	neighbours.assign(size, 0);
+	tile_values.assign(size, 0);
+	for(unsigned player = 0; player < 2; ++player) {
+		window_tiles[player].assign(window_start.size(), 0);
+		threat_windows[player].assign(size, 0);
+		num_patterns[player].assign(line_length + 1, 0);
+		score[player] = 0;
+		num_threats[player] = 0;
+	}
+
+	for(size_type index = 0; index < size; ++index) {
+		if (position[index] != field::tile::empty) {
+			make_move(index, position[index]);
+		}
+	}
+}
+
+void tictactoe::pattern_evaluator::make_move(size_type index, field::tile state) {
+	assert(static_cast<field::tile>(tiles[index]) == field::tile::empty && state != field::tile::empty);
+	const unsigned player = slot(state);
+
+	for(size_type entry = tile_windows_begin[index]; entry < tile_windows_begin[index + 1]; ++entry) {
+		update_window(tile_windows[entry], -1);
+	}
+	tiles[index] = static_cast<std::uint8_t>(state);
+	for(size_type entry = tile_windows_begin[index]; entry < tile_windows_begin[index + 1]; ++entry) {
+		++window_tiles[player][tile_windows[entry]];
+		update_window(tile_windows[entry], 1);
+	}
+	update_neighbours(index, 1);
+}
+
+void tictactoe::pattern_evaluator::unmake_move(size_type index) {
+	assert(static_cast<field::tile>(tiles[index]) != field::tile::empty);
+	const unsigned player = slot(static_cast<field::tile>(tiles[index]));
+
+	for(size_type entry = tile_windows_begin[index]; entry < tile_windows_begin[index + 1]; ++entry) {
+		update_window(tile_windows[entry], -1);
+		--window_tiles[player][tile_windows[entry]];
+	}
+	tiles[index] = static_cast<std::uint8_t>(field::tile::empty);
+	for(size_type entry = tile_windows_begin[index]; entry < tile_windows_begin[index + 1]; ++entry) {
+		update_window(tile_windows[entry], 1);
+	}
+	update_neighbours(index, -1);
+}
+
+void tictactoe::pattern_evaluator::update_window(size_type window, int sign) {
+	const unsigned
+		player1_tiles = window_tiles[0][window],
+		player2_tiles = window_tiles[1][window];
+	if ((0 == player1_tiles) == (0 == player2_tiles)) {
+		return; // either empty or blocked for both players
+	}
+
+	// an open pattern of n tiles is worth 4^(n - 1), like in searcher::evaluate
+	const unsigned
+		player = player1_tiles ? 0 : 1,
+		num_tiles = player1_tiles + player2_tiles;
+	const std::int64_t weight = sign * (std::int64_t(1) << (2 * (num_tiles - 1)));
+	score[player] += weight;
+	num_patterns[player][num_tiles] += sign;
+
+	const bool threat = num_tiles + 1 == line_length;
+	for(size_type offset = 0, index = window_start[window]; offset < line_length; ++offset, index += window_step[window]) {
+		if (static_cast<field::tile>(tiles[index]) != field::tile::empty) {
+			continue;
+		}
+		tile_values[index] += weight;
+		if (threat) {
+			if (0 < sign && 0 == threat_windows[player][index]++) {
+				++num_threats[player];
+			}
+			else if (sign < 0 && 0 == --threat_windows[player][index]) {
+				--num_threats[player];
+			}
+		}
+	}
+}
+
+void tictactoe::pattern_evaluator::update_neighbours(size_type index, int sign) {
+	const int
+		order = static_cast<int>(field_order),
+		x = static_cast<int>(index) % order,
+		y = static_cast<int>(index) / order;
+	for(int cy = std::max(0, y - neighbourhood); cy <= std::min(order - 1, y + neighbourhood); ++cy) {
+		for(int cx = std::max(0, x - neighbourhood); cx <= std::min(order - 1, x + neighbourhood); ++cx) {
+			neighbours[cy * order + cx] += sign;
+		}
+	}
+}
+
+int tictactoe::pattern_evaluator::evaluate(field::tile current_player) const noexcept {
+	const unsigned player = slot(current_player);
+	const std::int64_t value = score[player] - score[1 - player];
+	return static_cast<int>(std::max<std::int64_t>(-searcher::win_bound + 1, std::min<std::int64_t>(searcher::win_bound - 1, value)));
+}
+
+tictactoe::field::size_type tictactoe::pattern_evaluator::patterns(field::tile player, size_type num_tiles) const noexcept {
+	return num_patterns[slot(player)][num_tiles];
+}
+
+bool tictactoe::pattern_evaluator::forced_moves(field::tile current_player, std::vector<size_type> &moves) const {
+	moves.clear();
+	const unsigned player = slot(current_player);
+
+	// win if possible, otherwise block the opponent's wins
+	const unsigned forced =
+		num_threats[player] ? player :
+		num_threats[1 - player] ? 1 - player :
+		2;
+	if (2 == forced) {
+		return false;
+	}
+	for(size_type index = 0; index < tiles.size() && moves.size() < num_threats[forced]; ++index) {
+		if (threat_windows[forced][index]) {
+			moves.push_back(index);
+		}
+	}
+	return true;
+}
+
+void tictactoe::pattern_evaluator::generate_moves(field::tile current_player, std::vector<size_type> &moves) const {
+	if (forced_moves(current_player, moves)) {
+		return;
+	}
+
+	for(size_type index = 0; index < tiles.size(); ++index) {
+		if (is_candidate(index)) {
+			moves.push_back(index);
+		}
+	}
+	// nothing played yet; if the center was played, there are candidates
+	// until the field is full
+	const size_type center = (field_order / 2) * field_order + field_order / 2;
+	if (moves.empty() && static_cast<field::tile>(tiles[center]) == field::tile::empty) {
+		moves.push_back(center);
+	}
+
+	std::stable_sort(moves.begin(), moves.end(), [this](size_type lhs, size_type rhs) {
+		return tile_values[lhs] > tile_values[rhs];
+	});
+}
@@ -0,0 +1,145 @@
+#ifndef TICTACTOE_PATTERN_EVALUATOR_HPP_INCLUDED
+#define TICTACTOE_PATTERN_EVALUATOR_HPP_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include "field.hpp"
+#include "field_position.hpp"
+
+namespace tictactoe {
+
+/**
+ * An incrementally updated evaluation of a field position, meant for large
+ * fields like 15x15 with 5 in a row.
+ *
+ * Every line segment of win_length() tiles (a window) caches the number of
+ * tiles each player has in it. A window that holds tiles of only one player
+ * is an open pattern of that player: with 5 in a row, windows of 2, 3 and 4
+ * tiles are the open twos, threes and fours. make_move() and unmake_move()
+ * only revisit the windows through the changed tile, i.e. at most
+ * 4 * win_length() windows, instead of rescanning the field.
+ *
+ * The evaluator also tracks the tiles that complete a window, i.e. win the
+ * game, for each player, and which tiles are close to tiles already played,
+ * for threat based move generation.
+ */
+struct pattern_evaluator {
+	typedef field::size_type size_type;
+
+	/**
+	 * Create an evaluator for an empty 3x3 field.
+	 */
+	pattern_evaluator();
+
+	/**
+	 * Create an evaluator for a position.
+	 */
+	explicit pattern_evaluator(const field_position &position);
+
+	/**
+	 * Re-initializes the evaluator for a position, possibly of a different
+	 * order or win length.
+	 */
+	void reset(const field_position &position);
+
+	/**
+	 * Updates the evaluation for a tile that was played.
+	 * \param index The flat index of the tile; it has to be empty.
+	 * \param state The state played on the tile.
+	 */
+	void make_move(size_type index, field::tile state);
+
+	/**
+	 * Updates the evaluation for a tile that was taken back.
+	 * \param index The flat index of the tile; it must not be empty.
+	 */
+	void unmake_move(size_type index);
+
+	/**
+	 * Returns the evaluation from the point of view of current_player. It
+	 * equals searcher::evaluate() of the same position.
+	 */
+	int evaluate(field::tile current_player) const noexcept;
+
+	/**
+	 * Returns the number of open patterns of a player.
+	 * \param player The state of the player.
+	 * \param tiles The number of the player's tiles in the pattern; at most
+	 *        win_length().
+	 */
+	size_type patterns(field::tile player, size_type tiles) const noexcept;
+
+	/**
+	 * Returns the number of distinct empty tiles that would win the game for
+	 * a player.
+	 */
+	size_type threats(field::tile player) const noexcept { return num_threats[slot(player)]; }
+
+	/**
+	 * Returns whether playing an empty tile would win the game for a player.
+	 */
+	bool is_threat(field::tile player, size_type index) const noexcept { return 0 != threat_windows[slot(player)][index]; }
+
+	/**
+	 * Returns the weight of all open patterns of both players an empty tile
+	 * takes part in; tiles with a higher value are more urgent to play.
+	 */
+	std::int64_t tile_value(size_type index) const noexcept { return tile_values[index]; }
+
+	/**
+	 * Returns whether a tile is empty and at most two rows or columns away
+	 * from a tile that was played.
+	 */
+	bool is_candidate(size_type index) const noexcept {
+		return field::tile::empty == static_cast<field::tile>(tiles[index]) && 0 != neighbours[index];
+	}
+
+	/**
+	 * Generates the moves that can't lose immediately, if that is a proper
+	 * subset of all moves: the tiles that win for current_player, or else
+	 * the tiles that block the opponent's win.
+	 * \param moves Receives the forced moves in index order.
+	 * \return false if there are no forced moves; moves is left empty.
+	 */
+	bool forced_moves(field::tile current_player, std::vector<size_type> &moves) const;
+
+	/**
+	 * Generates the moves worth searching on a large field: the forced moves,
+	 * if any, and otherwise the candidate tiles ordered by decreasing
+	 * tile_value(). On an empty field, only the center is generated.
+	 * \note Moves far away from all played tiles are pruned, so a search
+	 *       using these moves is no longer exhaustive.
+	 */
+	void generate_moves(field::tile current_player, std::vector<size_type> &moves) const;
+
+private:
+	static unsigned slot(field::tile player) noexcept { return (player == field::tile::player2) ? 1 : 0; }
+
+	void update_window(size_type window, int sign);
+	void update_neighbours(size_type index, int sign);
+
+	size_type field_order;
+	size_type line_length;
+
+	// windows: first tile and step between tiles
+	std::vector<std::uint16_t> window_start;
+	std::vector<std::int16_t> window_step;
+	// windows through each tile; the windows of tile i are
+	// tile_windows[tile_windows_begin[i] .. tile_windows_begin[i + 1])
+	std::vector<std::uint16_t> tile_windows_begin;
+	std::vector<std::uint16_t> tile_windows;
+
+	std::vector<std::uint8_t> tiles;
+	std::vector<std::uint8_t> window_tiles[2];
+	std::vector<std::uint8_t> threat_windows[2];
+	std::vector<std::uint8_t> neighbours;
+	std::vector<std::int64_t> tile_values;
+	std::vector<size_type> num_patterns[2];
+	std::int64_t score[2];
+	size_type num_threats[2];
+};
+
+}
+
+#endif // TICTACTOE_PATTERN_EVALUATOR_HPP_INCLUDED
@@ -0,0 +1,46 @@
+#include "pattern_player.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "game.hpp"
+
+tictactoe::pattern_player::pattern_player(const std::vector<field::size_type> &pattern, std::uint64_t seed) {
+	std::stringstream namebuilder;
+	namebuilder << "pattern_player({";
+
+	moves.reserve(pattern.size());
+	for(const auto move_pattern : pattern) {
+		const auto move = seed % move_pattern;
+		seed /= move_pattern;
+
+		if (!moves.empty()) namebuilder << ", ";
+		namebuilder << move;
+		moves.emplace_back(move);
+	}
+	next_move = moves.begin();
+
+	namebuilder << "}) @ " << static_cast<const void *>(this);
+	player_name = namebuilder.str();
+}
+
+std::string tictactoe::pattern_player::name() const {
+	return player_name;
+}
+
+void tictactoe::pattern_player::make_move(game_make_move_interface game_interface) {
+	if (next_move == moves.end()) {
+		throw std::runtime_error("The pattern has no move left.");
+	}
+	for(field::size_type index = 0; index < game_interface.field().size(); ++index) {
+		if (game_interface[index] == field::tile::empty) {
+			if (0 == *next_move) {
+				++next_move;
+				game_interface.make_move(index);
+				return;
+			}
+			--*next_move;
+		}
+	}
+	throw std::runtime_error("Too few tiles are empty for the pattern.");
+}
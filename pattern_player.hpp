@@ -0,0 +1,43 @@
+#ifndef TICTACTOE_PATTERN_PLAYER_HPP_INCLUDED
+#define TICTACTOE_PATTERN_PLAYER_HPP_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "field.hpp"
+#include "player.hpp"
+
+namespace tictactoe {
+
+/**
+ * A player following a fixed pattern: for each entry n of the pattern it
+ * plays one of the first n empty tiles, picked by a digit of the seed in the
+ * mixed radix the pattern gives. The seeds from 0 up to the product of the
+ * entries enumerate all games of such a player.
+ */
+struct pattern_player : player {
+	/**
+	 * Create a new pattern player.
+	 * \param pattern The number of empty tiles to choose from for each move.
+	 * \param seed Selects the tile of each move.
+	 */
+	pattern_player(const std::vector<field::size_type> &pattern, std::uint64_t seed);
+
+	std::string name() const override;
+
+	/**
+	 * \throw std::runtime_error if the pattern has no move left or fewer
+	 *        tiles are empty than the move needs.
+	 */
+	void make_move(game_make_move_interface) override;
+
+private:
+	std::string player_name;
+	std::vector<field::size_type> moves;
+	std::vector<field::size_type>::iterator next_move;
+};
+
+}
+
+#endif // TICTACTOE_PATTERN_PLAYER_HPP_INCLUDED
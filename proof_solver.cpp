@@ -0,0 +1,581 @@
+#include "proof_solver.hpp"
+
+#ifndef _WIN32
+#	include <sys/resource.h>
+#endif
+
+#include <cassert>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "tracing.hpp"
+#include "zobrist.hpp"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef tictactoe::field::size_type size_type;
+
+	constexpr std::uint32_t infinity = 0xffffffff;
+	constexpr std::size_t bucket_size = 4;
+
+	// keeps the tables of both attackers apart
+	constexpr std::uint64_t player2_attacks = 0x5bd1e9955bd1e995ull;
+
+	/**
+	 * Adds proof or disproof numbers; the sum only becomes infinite if one of
+	 * them is.
+	 */
+	std::uint32_t add(std::uint32_t lhs, std::uint32_t rhs) {
+		if (infinity == lhs || infinity == rhs) {
+			return infinity;
+		}
+		return static_cast<std::uint32_t>(std::min<std::uint64_t>(std::uint64_t(lhs) + rhs, infinity - 1));
+	}
+
+	/**
+	 * Returns the threshold for the most proving child: a quarter more than
+	 * the second best child, so the search does not switch back and forth
+	 * between siblings of almost the same numbers (the 1 + epsilon trick).
+	 */
+	std::uint32_t widen(std::uint32_t second_best) {
+		return add(second_best, second_best / 4 + 1);
+	}
+
+	tictactoe::field::tile other(tictactoe::field::tile player) {
+		return (player == tictactoe::field::tile::player1)
+			? tictactoe::field::tile::player2
+			: tictactoe::field::tile::player1;
+	}
+
+	char symbol(tictactoe::field::tile state) {
+		return
+			(state == tictactoe::field::tile::player1) ? 'X' :
+			(state == tictactoe::field::tile::player2) ? 'O' :
+			'.';
+	}
+
+	std::size_t peak_memory() {
+#ifdef _WIN32
+		// Workaround for Windows: no getrusage, so the peak is unavailable
+		return 0;
+#else
+		rusage usage;
+		if (0 != getrusage(RUSAGE_SELF, &usage)) {
+			return 0;
+		}
+		return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // kB on Linux
+#endif
+	}
+
+	/**
+	 * Replays a proof tree on a field, see tictactoe::check_proof().
+	 */
+	struct proof_checker {
+		typedef std::vector<std::pair<size_type, std::uint32_t>> node_moves;
+
+		proof_checker(const std::unordered_map<std::uint32_t, node_moves> &nodes, const tictactoe::proof_claim &claim)
+		: nodes(nodes)
+		, claim(claim)
+		, position(claim.position)
+		, owner(claim.attacker_wins ? claim.attacker : other(claim.attacker)) {}
+
+		void check(std::uint32_t node, tictactoe::field::tile player) {
+			using tictactoe::field;
+
+			const auto found = nodes.find(node);
+			if (found == nodes.end()) {
+				throw std::runtime_error("Proof node " + std::to_string(node) + " is missing.");
+			}
+			const std::string key = tictactoe::symmetry::key(position, player);
+			const auto seen = positions.find(node);
+			if (seen != positions.end()) {
+				if (seen->second != key) {
+					throw std::runtime_error("Proof node " + std::to_string(node) + " is reached with different positions.");
+				}
+				return;
+			}
+			positions.emplace(node, key);
+
+			const node_moves &moves = found->second;
+			size_type empty_tiles = 0;
+			for(size_type index = 0; index < position.size(); ++index) {
+				empty_tiles += (position[index] == field::tile::empty);
+			}
+			if (player == owner ? 1 != moves.size() : empty_tiles != moves.size()) {
+				throw std::runtime_error("Proof node " + std::to_string(node) + ((player == owner)
+					? " does not have exactly one move."
+					: " does not answer every move."));
+			}
+
+			std::vector<bool> listed(position.size(), false);
+			for(const auto &move : moves) {
+				if (position.size() <= move.first || position[move.first] != field::tile::empty || listed[move.first]) {
+					throw std::runtime_error("Proof node " + std::to_string(node) + " has an illegal or repeated move.");
+				}
+				listed[move.first] = true;
+				position[move.first] = player;
+				const bool won = position.check_win_condition(move.first);
+				if (won || 1 == empty_tiles) {
+					if ((won && player == claim.attacker) != claim.attacker_wins) {
+						throw std::runtime_error("Proof node " + std::to_string(node) + " ends in the wrong result.");
+					}
+					if (move.second) {
+						throw std::runtime_error("Proof node " + std::to_string(node) + " continues a finished game.");
+					}
+				}
+				else if (!move.second) {
+					throw std::runtime_error("Proof node " + std::to_string(node) + " ends an ongoing game.");
+				}
+				else {
+					check(move.second, other(player));
+				}
+				position[move.first] = field::tile::empty;
+			}
+		}
+
+		const std::unordered_map<std::uint32_t, node_moves> &nodes;
+		const tictactoe::proof_claim &claim;
+		tictactoe::field position;
+		tictactoe::field::tile owner;
+		std::unordered_map<std::uint32_t, std::string> positions;
+	};
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::proof_solver
+//
+
+tictactoe::proof_solver::proof_solver(std::size_t table_memory)
+: num_buckets(1)
+, current()
+, evaluator()
+, attacker(field::tile::player1)
+, max_nodes(0)
+, aborted(false)
+, stats()
+, side_key(0)
+, next_node(0) {
+	while(num_buckets * 2 * bucket_size * sizeof(entry) <= table_memory) {
+		num_buckets *= 2;
+	}
+	table.reset(new entry[num_buckets * bucket_size]());
+	stats.table_memory = num_buckets * bucket_size * sizeof(entry);
+}
+
+void tictactoe::proof_solver::clear() {
+	std::fill(table.get(), table.get() + num_buckets * bucket_size, entry());
+	stats.table_entries = 0;
+}
+
+tictactoe::proof_result tictactoe::proof_solver::solve(const field_position &position, std::uint64_t max_nodes) {
+	const field::tile player = position.current_player();
+	proof_result result = prove(position, player, max_nodes);
+	if (result != proof_result::loss) {
+		return result;
+	}
+
+	// no win, so it is a draw unless the opponent wins
+	const std::uint64_t nodes = stats.nodes;
+	const std::chrono::duration<double> elapsed = stats.elapsed;
+	const proof_result opponent = prove(position, other(player), max_nodes);
+	stats.nodes += nodes;
+	stats.elapsed += elapsed;
+	return
+		(opponent == proof_result::win) ? proof_result::loss :
+		(opponent == proof_result::loss) ? proof_result::draw :
+		proof_result::unknown;
+}
+
+tictactoe::proof_result tictactoe::proof_solver::prove(const field_position &position, field::tile attacker, std::uint64_t max_nodes) {
+	TICTACTOE_TRACE_SPAN("proof_solver::prove");
+	start(position, attacker, max_nodes);
+	std::uint32_t proof, disproof;
+	search(infinity, infinity, 0, proof, disproof);
+	finish();
+	return
+		(0 == proof) ? proof_result::win :
+		(0 == disproof) ? proof_result::loss :
+		proof_result::unknown;
+}
+
+tictactoe::proof_result tictactoe::proof_solver::write_proof(std::ostream &os, const field_position &position, field::tile attacker) {
+	const proof_result result = prove(position, attacker);
+	const std::uint64_t nodes = stats.nodes;
+	const std::chrono::duration<double> elapsed = stats.elapsed;
+
+	os << "proof " << position.order() << ' ' << position.win_length() << ' ';
+	for(size_type index = 0; index < position.size(); ++index) {
+		os << symbol(position[index]);
+	}
+	os <<
+		' ' << symbol(position.current_player()) <<
+		' ' << symbol(attacker) <<
+		' ' << ((result == proof_result::win) ? "win" : "no-win") << '\n';
+
+	// the table already holds the proof, so this mostly looks it up again
+	TICTACTOE_TRACE_SPAN("proof_solver::write_proof");
+	start(position, attacker, 0);
+	std::unordered_map<std::uint64_t, std::uint32_t> written;
+	next_node = 0;
+	const std::uint32_t root = write_node(os, 0, result == proof_result::win, written);
+	os << "end " << root << '\n';
+	finish();
+
+	stats.nodes += nodes;
+	stats.elapsed += elapsed;
+	return result;
+}
+
+void tictactoe::proof_solver::start(const field_position &position, field::tile attacker, std::uint64_t max_nodes) {
+	assert(position.game_status() == field_position::status::ongoing);
+	this->attacker = attacker;
+	this->max_nodes = max_nodes;
+	aborted = false;
+	stats.nodes = 0;
+	started = clock_type::now();
+
+	current = position;
+	evaluator.reset(position);
+	const size_type order = position.order(), win_length = position.win_length();
+	tile_keys.resize(position.size() * 2 * symmetry::count);
+	for(size_type index = 0; index < position.size(); ++index) {
+		for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+			const size_type transformed = symmetry::transform_index(order, index, transformation);
+			tile_keys[(2 * index + 0) * symmetry::count + transformation] = zobrist::tile_key(order, win_length, transformed, field::tile::player1);
+			tile_keys[(2 * index + 1) * symmetry::count + transformation] = zobrist::tile_key(order, win_length, transformed, field::tile::player2);
+		}
+	}
+	side_key = zobrist::side_key(order, win_length);
+
+	for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+		hashes[transformation] = (position.current_player() == field::tile::player2) ? side_key : 0;
+		for(size_type index = 0; index < position.size(); ++index) {
+			if (position[index] != field::tile::empty) {
+				hashes[transformation] ^= tile_keys[(2 * index + (position[index] == field::tile::player2)) * symmetry::count + transformation];
+			}
+		}
+	}
+
+	children.resize(position.empty_tiles() + 1);
+}
+
+void tictactoe::proof_solver::finish() {
+	stats.elapsed = clock_type::now() - started;
+	stats.peak_memory = peak_memory();
+}
+
+void tictactoe::proof_solver::search(std::uint32_t proof_threshold, std::uint32_t disproof_threshold, unsigned ply, std::uint32_t &proof, std::uint32_t &disproof) {
+	const std::uint64_t first_node = ++stats.nodes;
+	if (max_nodes && max_nodes <= stats.nodes) {
+		aborted = true;
+	}
+
+	expand(ply);
+	std::vector<child> &list = children[ply];
+	const bool attacking = current.current_player() == attacker;
+	// the attacker needs one proven move, the defender one disproven move;
+	// "first" is the number the player to move minimises
+	auto first = [attacking](const child &move) { return attacking ? move.proof : move.disproof; };
+	auto second = [attacking](const child &move) { return attacking ? move.disproof : move.proof; };
+
+	for(;;) {
+		std::uint32_t best_first = infinity, second_best_first = infinity, sum_second = 0;
+		std::size_t best = 0;
+		for(std::size_t index = 0; index < list.size(); ++index) {
+			const child &move = list[index];
+			if (first(move) < best_first) {
+				second_best_first = best_first;
+				best_first = first(move);
+				best = index;
+			}
+			else if (first(move) < second_best_first) {
+				second_best_first = first(move);
+			}
+			sum_second = add(sum_second, second(move));
+		}
+		proof = attacking ? best_first : sum_second;
+		disproof = attacking ? sum_second : best_first;
+		if (aborted || proof_threshold <= proof || disproof_threshold <= disproof) {
+			break;
+		}
+
+		const std::uint32_t
+			first_threshold = attacking ? proof_threshold : disproof_threshold,
+			second_threshold = attacking ? disproof_threshold : proof_threshold,
+			child_first = std::min(first_threshold, widen(second_best_first)),
+			child_second = (infinity == second_threshold)
+				? infinity
+				: second_threshold - sum_second + second(list[best]);
+
+		child &move = list[best];
+		play(move.move);
+		search(
+			attacking ? child_first : child_second,
+			attacking ? child_second : child_first,
+			ply + 1, move.proof, move.disproof
+		);
+		take_back(move.move);
+	}
+
+	store(key(), proof, disproof, stats.nodes - first_node + 1);
+}
+
+void tictactoe::proof_solver::expand(unsigned ply) {
+	std::vector<child> &list = children[ply];
+	list.clear();
+	const field::tile player = current.current_player();
+	const bool attacking = player == attacker;
+	const unsigned side = (player == field::tile::player2);
+
+	if (!evaluator.forced_moves(player, forced)) {
+		for(size_type index = 0; index < current.size(); ++index) {
+			if (current[index] == field::tile::empty) {
+				forced.push_back(index);
+			}
+		}
+	}
+
+	for(const size_type index : forced) {
+		child move = { index, 0, 1, 1, true };
+		if (evaluator.is_threat(player, index)) {
+			// completes a line
+			move.proof = attacking ? 0 : infinity;
+			move.disproof = attacking ? infinity : 0;
+		}
+		else if (1 == current.empty_tiles()) {
+			// a draw is no win for the attacker
+			move.proof = infinity;
+			move.disproof = 0;
+		}
+		else {
+			move.terminal = false;
+			move.key = ~std::uint64_t(0);
+			for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+				move.key = std::min(move.key, hashes[transformation] ^ tile_keys[(2 * index + side) * symmetry::count + transformation] ^ side_key);
+			}
+			if (attacker == field::tile::player2) {
+				move.key ^= player2_attacks;
+			}
+			lookup(move.key, move.proof, move.disproof);
+		}
+		list.push_back(move);
+	}
+}
+
+std::uint64_t tictactoe::proof_solver::key() const noexcept {
+	return *std::min_element(hashes, hashes + symmetry::count) ^ ((attacker == field::tile::player2) ? player2_attacks : 0);
+}
+
+void tictactoe::proof_solver::play(field::size_type index) {
+	const field::tile player = current.current_player();
+	const unsigned side = (player == field::tile::player2);
+	for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+		hashes[transformation] ^= tile_keys[(2 * index + side) * symmetry::count + transformation] ^ side_key;
+	}
+	evaluator.make_move(index, player);
+	current.make_move(index);
+}
+
+void tictactoe::proof_solver::take_back(field::size_type index) {
+	const unsigned side = (current[index] == field::tile::player2);
+	current.unmake_move();
+	evaluator.unmake_move(index);
+	for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+		hashes[transformation] ^= tile_keys[(2 * index + side) * symmetry::count + transformation] ^ side_key;
+	}
+}
+
+bool tictactoe::proof_solver::lookup(std::uint64_t key, std::uint32_t &proof, std::uint32_t &disproof) const {
+	const entry *bucket = &table[(key & (num_buckets - 1)) * bucket_size];
+	for(std::size_t slot = 0; slot < bucket_size; ++slot) {
+		if (bucket[slot].work && bucket[slot].key == key) {
+			proof = bucket[slot].proof;
+			disproof = bucket[slot].disproof;
+			return true;
+		}
+	}
+	return false;
+}
+
+void tictactoe::proof_solver::store(std::uint64_t key, std::uint32_t proof, std::uint32_t disproof, std::uint64_t work) {
+	// replace the same position, an empty slot or the smallest subtree
+	entry *bucket = &table[(key & (num_buckets - 1)) * bucket_size];
+	entry *target = bucket;
+	for(std::size_t slot = 0; slot < bucket_size; ++slot) {
+		if (bucket[slot].work && bucket[slot].key == key) {
+			target = &bucket[slot];
+			work += target->work;
+			break;
+		}
+		if (bucket[slot].work < target->work) {
+			target = &bucket[slot];
+		}
+	}
+	stats.table_entries += (0 == target->work);
+	target->key = key;
+	target->proof = proof;
+	target->disproof = disproof;
+	target->work = static_cast<std::uint32_t>(std::min<std::uint64_t>(work, infinity));
+}
+
+std::uint32_t tictactoe::proof_solver::write_node(std::ostream &os, unsigned ply, bool attacker_wins, std::unordered_map<std::uint64_t, std::uint32_t> &written) {
+	const std::uint64_t hash = current.hash();
+	const auto found = written.find(hash);
+	if (found != written.end()) {
+		return found->second;
+	}
+
+	// settles the node, after which its children show how
+	std::uint32_t proof, disproof;
+	search(infinity, infinity, ply, proof, disproof);
+	assert(attacker_wins ? 0 == proof : 0 == disproof);
+	const std::vector<child> &list = children[ply];
+	const bool owner = (current.current_player() == attacker) == attacker_wins;
+
+	std::vector<std::pair<size_type, std::uint32_t>> moves;
+	auto write_move = [&](const child &move) {
+		std::uint32_t next = 0;
+		if (!move.terminal) {
+			play(move.move);
+			next = write_node(os, ply + 1, attacker_wins, written);
+			take_back(move.move);
+		}
+		moves.emplace_back(move.move, next);
+	};
+
+	if (owner) {
+		// a single move that settles the node
+		for(const child &move : list) {
+			if (0 == (attacker_wins ? move.proof : move.disproof)) {
+				write_move(move);
+				break;
+			}
+		}
+	}
+	else {
+		for(size_type index = 0; index < current.size(); ++index) {
+			if (current[index] != field::tile::empty) {
+				continue;
+			}
+			const auto move = std::find_if(list.begin(), list.end(), [index](const child &move) { return move.move == index; });
+			if (move != list.end()) {
+				write_move(*move);
+				continue;
+			}
+
+			// a move that was not searched since it leaves a line open for
+			// the owner, who completes it at once
+			play(index);
+			std::uint32_t &next = written[current.hash()];
+			if (!next) {
+				evaluator.forced_moves(current.current_player(), forced);
+				next = ++next_node;
+				os << next << ' ' << forced.front() << ":0\n";
+			}
+			moves.emplace_back(index, next);
+			take_back(index);
+		}
+	}
+
+	const std::uint32_t node = ++next_node;
+	os << node;
+	for(const auto &move : moves) {
+		os << ' ' << move.first << ':' << move.second;
+	}
+	os << '\n';
+	written.emplace(hash, node);
+	return node;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::check_proof
+//
+
+tictactoe::proof_claim tictactoe::check_proof(std::istream &proof) {
+	auto parse_player = [](char player) {
+		if ('X' != player && 'O' != player) {
+			throw std::runtime_error("Invalid player in proof header.");
+		}
+		return ('X' == player) ? field::tile::player1 : field::tile::player2;
+	};
+
+	std::string line, magic, tiles, result;
+	char player = 0, attacker = 0;
+	size_type order = 0, win_length = 0;
+	if (!std::getline(proof, line)) {
+		throw std::runtime_error("Missing proof header.");
+	}
+	std::stringstream header(line);
+	if (
+		!(header >> magic >> order >> win_length >> tiles >> player >> attacker >> result) ||
+		"proof" != magic || 0 == order || field_position::max_order < order ||
+		order < win_length || tiles.size() != order * order || ("win" != result && "no-win" != result)
+	) {
+		throw std::runtime_error("Invalid proof header.");
+	}
+
+	proof_claim claim = { field(order, win_length), parse_player(player), parse_player(attacker), "win" == result, 0 };
+	for(size_type index = 0; index < tiles.size(); ++index) {
+		if ('.' != tiles[index]) {
+			claim.position[index] = parse_player(tiles[index]);
+		}
+	}
+	bool has_empty_tiles = false;
+	for(size_type index = 0; index < claim.position.size(); ++index) {
+		has_empty_tiles = has_empty_tiles || claim.position[index] == field::tile::empty;
+		if (claim.position[index] != field::tile::empty && claim.position.check_win_condition(index)) {
+			throw std::runtime_error("The proof starts from a finished game.");
+		}
+	}
+	if (!has_empty_tiles) {
+		throw std::runtime_error("The proof starts from a finished game.");
+	}
+
+	std::unordered_map<std::uint32_t, proof_checker::node_moves> nodes;
+	std::uint32_t root = 0;
+	while(std::getline(proof, line)) {
+		std::stringstream entry(line);
+		std::string first;
+		entry >> first;
+		if ("end" == first) {
+			if (!(entry >> root) || !nodes.count(root)) {
+				throw std::runtime_error("Invalid proof root.");
+			}
+			break;
+		}
+
+		std::stringstream id(first);
+		std::uint32_t node = 0;
+		if (!(id >> node) || 0 == node || nodes.count(node)) {
+			throw std::runtime_error("Invalid proof node: " + line);
+		}
+		proof_checker::node_moves &moves = nodes[node];
+		size_type move;
+		char separator;
+		std::uint32_t next;
+		while(entry >> move >> separator >> next) {
+			if (':' != separator) {
+				throw std::runtime_error("Invalid proof node: " + line);
+			}
+			moves.emplace_back(move, next);
+		}
+		if (!entry.eof()) {
+			throw std::runtime_error("Invalid proof node: " + line);
+		}
+	}
+	if (0 == root) {
+		throw std::runtime_error("Truncated proof.");
+	}
+
+	proof_checker checker(nodes, claim);
+	checker.check(root, claim.current_player);
+	claim.nodes = checker.positions.size();
+	return claim;
+}
@@ -0,0 +1,216 @@
+#ifndef TICTACTOE_PROOF_SOLVER_HPP_INCLUDED
+#define TICTACTOE_PROOF_SOLVER_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "field.hpp"
+#include "field_position.hpp"
+#include "pattern_evaluator.hpp"
+#include "symmetry.hpp"
+
+namespace tictactoe {
+
+/**
+ * The game theoretic value of a position for the player to move.
+ */
+enum class proof_result {
+	win,
+	loss,
+	draw,
+	/**
+	 * The node limit was reached first.
+	 */
+	unknown
+};
+
+/**
+ * Statistics of the most recent proof_solver::solve() or prove().
+ */
+struct proof_statistics {
+	/**
+	 * The number of positions expanded.
+	 */
+	std::uint64_t nodes;
+	std::chrono::duration<double> elapsed;
+
+	/**
+	 * The size of the transposition table in bytes.
+	 */
+	std::size_t table_memory;
+
+	/**
+	 * The number of table slots holding a position.
+	 */
+	std::size_t table_entries;
+
+	/**
+	 * The peak resident memory of the whole process in bytes, or 0 if it
+	 * is unavailable on this platform.
+	 */
+	std::size_t peak_memory;
+
+	double nodes_per_second() const { return elapsed.count() > 0 ? nodes / elapsed.count() : 0; }
+};
+
+/**
+ * A depth-first proof-number search (df-pn) that proves or disproves that a
+ * player can force a win.
+ *
+ * Every node carries a proof number, the number of leaves that still have to
+ * be proven to prove it, and a disproof number, the same for disproving it.
+ * The search always descends into the most proving child and only returns
+ * once the numbers exceed the thresholds of its parent, so it needs no more
+ * memory than its transposition table and the current path. The table has a
+ * fixed size and keeps the positions with the largest subtrees; positions are
+ * folded over the eight symmetries of the field. Moves that lose at once are
+ * not searched when a win or block is possible, see
+ * pattern_evaluator::forced_moves().
+ *
+ * write_proof() writes the proof tree of a result, which check_proof() checks
+ * without using the solver.
+ */
+struct proof_solver {
+	/**
+	 * Create a solver.
+	 * \param table_memory The size of the transposition table in bytes; at
+	 *        least one bucket of four slots is used.
+	 */
+	explicit proof_solver(std::size_t table_memory = std::size_t(64) << 20);
+
+	/**
+	 * Solves a position by proving or disproving a win for both players.
+	 * \param position The position; its game_status() has to be ongoing.
+	 * \param max_nodes The maximum number of nodes per proof, or 0 for no
+	 *        limit.
+	 */
+	proof_result solve(const field_position &position, std::uint64_t max_nodes = 0);
+
+	/**
+	 * Proves or disproves that attacker can force a win.
+	 * \param position The position; its game_status() has to be ongoing.
+	 * \param attacker The state of the player trying to win.
+	 * \param max_nodes See solve().
+	 * \return proof_result::win if attacker wins, proof_result::loss if not,
+	 *         i.e. the game is a draw or a loss for attacker, or
+	 *         proof_result::unknown.
+	 */
+	proof_result prove(const field_position &position, field::tile attacker, std::uint64_t max_nodes = 0);
+
+	/**
+	 * Writes the proof tree of prove(position, attacker) in the format read
+	 * by check_proof().
+	 *
+	 * The tree is a list of nodes, each of them a position in the tree with
+	 * the moves to the next ones. At positions of the player the result
+	 * favours a single move is given, at positions of the other player all
+	 * moves. Transpositions share a node.
+	 * \return The result of prove(position, attacker).
+	 */
+	proof_result write_proof(std::ostream &os, const field_position &position, field::tile attacker);
+
+	/**
+	 * Returns the statistics of the most recent solve(), prove() or
+	 * write_proof().
+	 */
+	const proof_statistics &statistics() const noexcept { return stats; }
+
+	/**
+	 * Removes all entries from the transposition table.
+	 */
+	void clear();
+
+private:
+	struct entry {
+		std::uint64_t key;
+		std::uint32_t proof;
+		std::uint32_t disproof;
+		std::uint32_t work;
+	};
+
+	struct child {
+		field::size_type move;
+		std::uint64_t key;
+		std::uint32_t proof;
+		std::uint32_t disproof;
+		bool terminal;
+	};
+
+	void start(const field_position &position, field::tile attacker, std::uint64_t max_nodes);
+	void finish();
+	void search(std::uint32_t proof_threshold, std::uint32_t disproof_threshold, unsigned ply, std::uint32_t &proof, std::uint32_t &disproof);
+	void expand(unsigned ply);
+	std::uint64_t key() const noexcept;
+	void play(field::size_type index);
+	void take_back(field::size_type index);
+	bool lookup(std::uint64_t key, std::uint32_t &proof, std::uint32_t &disproof) const;
+	void store(std::uint64_t key, std::uint32_t proof, std::uint32_t disproof, std::uint64_t work);
+	std::uint32_t write_node(std::ostream &os, unsigned ply, bool attacker_wins, std::unordered_map<std::uint64_t, std::uint32_t> &written);
+
+	std::size_t num_buckets;
+	std::unique_ptr<entry[]> table;
+
+	field_position current;
+	pattern_evaluator evaluator;
+	field::tile attacker;
+	std::uint64_t max_nodes;
+	bool aborted;
+	proof_statistics stats;
+	std::chrono::steady_clock::time_point started;
+
+	// the Zobrist hashes of the position under each symmetry
+	std::uint64_t hashes[symmetry::count];
+	// the key of each state on each tile under each symmetry
+	std::vector<std::uint64_t> tile_keys;
+	std::uint64_t side_key;
+	// the children of the current path, one list per ply
+	std::vector<std::vector<child>> children;
+	std::vector<field::size_type> forced;
+	std::uint32_t next_node;
+};
+
+/**
+ * The claim of a proof tree, see proof_solver::write_proof().
+ */
+struct proof_claim {
+	field position;
+	field::tile current_player;
+	field::tile attacker;
+
+	/**
+	 * Whether attacker can force a win, or cannot.
+	 */
+	bool attacker_wins;
+
+	/**
+	 * The number of nodes of the tree.
+	 */
+	std::uint64_t nodes;
+};
+
+/**
+ * Checks a proof tree written by proof_solver::write_proof(), replaying it
+ * on a field independently of the solver.
+ *
+ * A proof tree is text, one line each:
+ *   proof <order> <win length> <tiles> <player to move> <attacker> win|no-win
+ *   <node> <move>:<next node> <move>:<next node> ...
+ *   ...
+ *   end <root node>
+ * Tiles and players are written as 'X', 'O' and '.', moves as flat tile
+ * indices. Nodes are numbered from 1 and listed after the nodes they lead to;
+ * a next node of 0 means the move ends the game.
+ * \return The claim proven by the tree.
+ * \throw std::runtime_error in case the tree is malformed or does not prove
+ *        its claim.
+ */
+proof_claim check_proof(std::istream &proof);
+
+}
+
+#endif // TICTACTOE_PROOF_SOLVER_HPP_INCLUDED
@@ -0,0 +1,132 @@
+#ifndef TICTACTOE_RULES_HPP_INCLUDED
+#define TICTACTOE_RULES_HPP_INCLUDED
+
+#include <cstdint>
+
+#include "field.hpp"
+#include "field_position.hpp"
+
+namespace tictactoe {
+/**
+ * Rule policies for the templated game loop and search engines, see
+ * simulation::game() and basic_searcher.
+ *
+ * A policy is a type with
+ *  - choices: the number of symbols a player can choose from for each tile,
+ *  - hash_key: a key added to position hashes, so the positions of different
+ *    rules never share transposition table entries,
+ *  - standard_lines: whether completing a line of one's own symbol wins, so
+ *    the line patterns of pattern_evaluator apply,
+ *  - symbol(mover, choice): the symbol a move places,
+ *  - line_winner(mover, line): the winner once mover has completed a line of
+ *    the symbol line,
+ *  - full_field_winner(): the winner once the field is full without a line,
+ * all of them static and known at compile time.
+ *
+ * Moves are encoded as index * choices + choice, so with a single choice a
+ * move is just the flat tile index.
+ */
+namespace rules {
+	/**
+	 * Each player places their own symbol; completing a line wins.
+	 */
+	struct standard {
+		static constexpr unsigned choices = 1;
+		static constexpr std::uint64_t hash_key = 0;
+		static constexpr bool standard_lines = true;
+
+		static field::tile symbol(field::tile mover, unsigned) noexcept { return mover; }
+		static field::tile line_winner(field::tile mover, field::tile) noexcept { return mover; }
+		static field::tile full_field_winner() noexcept { return field::tile::empty; }
+	};
+
+	/**
+	 * Misère: each player places their own symbol; completing a line loses.
+	 */
+	struct misere {
+		static constexpr unsigned choices = 1;
+		static constexpr std::uint64_t hash_key = 0x6d69736572650001;
+		static constexpr bool standard_lines = false;
+
+		static field::tile symbol(field::tile mover, unsigned) noexcept { return mover; }
+		static field::tile line_winner(field::tile mover, field::tile) noexcept {
+			return (mover == field::tile::player1) ? field::tile::player2 : field::tile::player1;
+		}
+		static field::tile full_field_winner() noexcept { return field::tile::empty; }
+	};
+
+	/**
+	 * Wild: either player may place either symbol; completing a line of
+	 * either symbol wins.
+	 */
+	struct wild {
+		static constexpr unsigned choices = 2;
+		static constexpr std::uint64_t hash_key = 0x77696c6400000002;
+		static constexpr bool standard_lines = false;
+
+		static field::tile symbol(field::tile, unsigned choice) noexcept {
+			return choice ? field::tile::player2 : field::tile::player1;
+		}
+		static field::tile line_winner(field::tile mover, field::tile) noexcept { return mover; }
+		static field::tile full_field_winner() noexcept { return field::tile::empty; }
+	};
+
+	/**
+	 * Order and Chaos: either player may place either symbol. Player 1
+	 * (Order) wins once any line of one symbol is completed, by whoever;
+	 * player 2 (Chaos) wins once the field is full without one. Usually
+	 * played on 6x6 with 5 in a row.
+	 */
+	struct order_and_chaos {
+		static constexpr unsigned choices = 2;
+		static constexpr std::uint64_t hash_key = 0x6f72646572000003;
+		static constexpr bool standard_lines = false;
+
+		static field::tile symbol(field::tile, unsigned choice) noexcept {
+			return choice ? field::tile::player2 : field::tile::player1;
+		}
+		static field::tile line_winner(field::tile, field::tile) noexcept { return field::tile::player1; }
+		static field::tile full_field_winner() noexcept { return field::tile::player2; }
+	};
+
+	/**
+	 * Returns the encoded move that places a choice on a tile.
+	 */
+	template<typename rules_type>
+	inline field::size_type make_move(field::size_type index, unsigned choice = 0) noexcept {
+		return index * rules_type::choices + choice;
+	}
+
+	/**
+	 * Returns the tile of an encoded move.
+	 */
+	template<typename rules_type>
+	inline field::size_type move_index(field::size_type move) noexcept {
+		return move / rules_type::choices;
+	}
+
+	/**
+	 * Returns the symbol an encoded move places for mover.
+	 */
+	template<typename rules_type>
+	inline field::tile move_symbol(field::size_type move, field::tile mover) noexcept {
+		return rules_type::symbol(mover, static_cast<unsigned>(move % rules_type::choices));
+	}
+
+	/**
+	 * Returns the winner of a decided position, or field::tile::empty for a
+	 * draw.
+	 * \param mover The player that made the last move.
+	 * \param status The status of the position, see field_position.
+	 */
+	template<typename rules_type>
+	inline field::tile winner(field::tile mover, field_position::status status) noexcept {
+		return
+			(status == field_position::status::player1_won) ? rules_type::line_winner(mover, field::tile::player1) :
+			(status == field_position::status::player2_won) ? rules_type::line_winner(mover, field::tile::player2) :
+			rules_type::full_field_winner();
+	}
+}
+}
+
+#endif // TICTACTOE_RULES_HPP_INCLUDED
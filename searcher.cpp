@@ -0,0 +1,369 @@
+#include "searcher.hpp"
+
+#include <cassert>
+#include <cstdlib>
+
+#include <algorithm>
+
+#include "tracing.hpp"
+#include "zobrist.hpp"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef tictactoe::field::size_type size_type;
+
+	constexpr int infinity = tictactoe::searcher::win_value + 1;
+
+	// on fields of at least this order, only moves near played tiles are
+	// searched, see pattern_evaluator::generate_moves()
+	constexpr size_type threat_pruning_order = 9;
+
+	int value_to_table(int value, unsigned ply) {
+		return
+			(value >  tictactoe::searcher::win_bound) ? value + static_cast<int>(ply) :
+			(value < -tictactoe::searcher::win_bound) ? value - static_cast<int>(ply) :
+			value;
+	}
+
+	int value_from_table(int value, unsigned ply) {
+		return
+			(value >  tictactoe::searcher::win_bound) ? value - static_cast<int>(ply) :
+			(value < -tictactoe::searcher::win_bound) ? value + static_cast<int>(ply) :
+			value;
+	}
+}
+
+template<typename rules_type>
+constexpr int tictactoe::basic_searcher<rules_type>::win_value;
+template<typename rules_type>
+constexpr int tictactoe::basic_searcher<rules_type>::win_bound;
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::search_limits
+//
+
+tictactoe::search_limits::search_limits()
+: start_depth(1)
+, max_depth(0xff)
+, deadline(clock_type::time_point::max())
+, stop(nullptr) {}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::basic_searcher
+//
+
+template<typename rules_type>
+tictactoe::basic_searcher<rules_type>::basic_searcher(transposition_table &table)
+: table(table)
+, current()
+, evaluator()
+, limits()
+, nodes(0)
+, completed_depth(0)
+, aborted(false) {}
+
+template<typename rules_type>
+std::uint64_t tictactoe::basic_searcher<rules_type>::hash(const field &position, field::tile current_player) {
+	return field_position(position, current_player).hash() ^ rules_type::hash_key;
+}
+
+template<typename rules_type>
+int tictactoe::basic_searcher<rules_type>::evaluate(const field &position, field::tile current_player) {
+	return evaluate(field_position(position, current_player));
+}
+
+template<typename rules_type>
+int tictactoe::basic_searcher<rules_type>::evaluate(const field_position &position) {
+	if (!rules_type::standard_lines) {
+		return 0;
+	}
+
+	const field::tile current_player = position.current_player();
+	const std::ptrdiff_t
+		order = position.order(),
+		length = position.win_length();
+	static const std::ptrdiff_t directions[][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+	int score = 0;
+	for(std::ptrdiff_t y = 0; y < order; ++y) {
+		for(std::ptrdiff_t x = 0; x < order; ++x) {
+			for(const auto &direction : directions) {
+				const std::ptrdiff_t
+					end_x = x + (length - 1) * direction[0],
+					end_y = y + (length - 1) * direction[1];
+				if (end_x < 0 || order <= end_x || order <= end_y) {
+					continue;
+				}
+
+				int mine = 0, theirs = 0;
+				for(std::ptrdiff_t step = 0; step < length; ++step) {
+					const field::tile state = position[(y + step * direction[1]) * order + x + step * direction[0]];
+					mine += (state == current_player);
+					theirs += (state != current_player && state != field::tile::empty);
+				}
+
+				// a line still open for one player is worth 4^(tiles - 1)
+				if (mine && !theirs) {
+					score += 1 << (2 * (mine - 1));
+				}
+				else if (theirs && !mine) {
+					score -= 1 << (2 * (theirs - 1));
+				}
+			}
+		}
+	}
+	return std::max(-win_bound + 1, std::min(win_bound - 1, score));
+}
+
+template<typename rules_type>
+tictactoe::search_result tictactoe::basic_searcher<rules_type>::search(const field &root, field::tile current_player, const search_limits &search_limits) {
+	return search(field_position(root, current_player), search_limits);
+}
+
+template<typename rules_type>
+tictactoe::search_result tictactoe::basic_searcher<rules_type>::search(const field_position &root, const search_limits &search_limits) {
+	TICTACTOE_TRACE_SPAN("searcher::search");
+	assert(root.game_status() == field_position::status::ongoing);
+	current = root;
+	if (rules_type::standard_lines) {
+		evaluator.reset(root);
+	}
+	limits = search_limits;
+	nodes = 0;
+	completed_depth = 0;
+	aborted = false;
+
+	const field::size_type order = current.order();
+	if (move_order.size() != current.size()) {
+		move_order.resize(current.size());
+		for(field::size_type index = 0; index < move_order.size(); ++index) {
+			move_order[index] = index;
+		}
+		// central tiles take part in more lines, so they tend to be better
+		auto distance = [order](field::size_type index) {
+			const std::ptrdiff_t
+				doubled_x = 2 * static_cast<std::ptrdiff_t>(index % order) - static_cast<std::ptrdiff_t>(order - 1),
+				doubled_y = 2 * static_cast<std::ptrdiff_t>(index / order) - static_cast<std::ptrdiff_t>(order - 1);
+			return std::max(std::abs(doubled_x), std::abs(doubled_y));
+		};
+		std::stable_sort(move_order.begin(), move_order.end(), [&](field::size_type lhs, field::size_type rhs) {
+			return distance(lhs) < distance(rhs);
+		});
+	}
+
+	const unsigned empty_tiles = static_cast<unsigned>(current.empty_tiles());
+	moves.resize(empty_tiles + 1);
+	pv.resize(empty_tiles + 1);
+	previous_pv.clear();
+
+	search_result result;
+	generate_moves(0, false, transposition_table::no_move);
+	result.move = moves[0].front();
+	result.value = 0;
+	result.depth = 0;
+
+	const unsigned max_depth = std::min(limits.max_depth, empty_tiles);
+	for(unsigned depth = std::max(1u, std::min(limits.start_depth, max_depth)); depth <= max_depth; ++depth) {
+		TICTACTOE_TRACE_SPAN("searcher::iteration");
+		int delta = 25, alpha = -infinity, beta = infinity;
+		if (0 < completed_depth && -win_bound <= result.value && result.value <= win_bound) {
+			alpha = result.value - delta;
+			beta = result.value + delta;
+		}
+
+		int value;
+		for(;;) {
+			value = negamax(depth, alpha, beta, 0, true);
+			if (aborted) {
+				break;
+			}
+			// widen the aspiration window on the side that failed
+			if (value <= alpha && -infinity < alpha) {
+				alpha = std::max(-infinity, value - delta);
+			}
+			else if (beta <= value && beta < infinity) {
+				beta = std::min(infinity, value + delta);
+			}
+			else {
+				break;
+			}
+			delta *= 4;
+		}
+		if (aborted) {
+			break;
+		}
+
+		completed_depth = depth;
+		previous_pv = pv[0];
+		result.move = pv[0].front();
+		result.value = value;
+		result.depth = depth;
+		if (value < -win_bound || win_bound < value) {
+			break; // the result is proven, deeper searches won't change it
+		}
+	}
+
+	result.nodes = nodes;
+	result.principal_variation = previous_pv;
+	return result;
+}
+
+template<typename rules_type>
+bool tictactoe::basic_searcher<rules_type>::should_stop() {
+	++nodes;
+	if (limits.stop && limits.stop->load(std::memory_order_relaxed)) {
+		return true;
+	}
+	return
+		0 < completed_depth &&
+		0 == (nodes & 0xff) &&
+		limits.deadline <= clock_type::now();
+}
+
+template<typename rules_type>
+void tictactoe::basic_searcher<rules_type>::generate_moves(unsigned ply, bool on_pv, unsigned table_move) {
+	std::vector<field::size_type> &list = moves[ply];
+	if (rules_type::standard_lines && threat_pruning_order <= current.order()) {
+		evaluator.generate_moves(current.current_player(), list);
+	}
+	else if (!rules_type::standard_lines || !evaluator.forced_moves(current.current_player(), list)) {
+		list.clear();
+		for(const field::size_type index : move_order) {
+			if (current[index] == field::tile::empty) {
+				for(unsigned choice = 0; choice < rules_type::choices; ++choice) {
+					list.push_back(rules::make_move<rules_type>(index, choice));
+				}
+			}
+		}
+	}
+
+	// the previous principal variation comes first, then the table's move
+	const field::size_type preferred = (on_pv && ply < previous_pv.size())
+		? previous_pv[ply]
+		: table_move;
+	const auto found = std::find(list.begin(), list.end(), preferred);
+	if (found != list.end()) {
+		std::rotate(list.begin(), found, found + 1);
+	}
+}
+
+template<typename rules_type>
+int tictactoe::basic_searcher<rules_type>::negamax(unsigned depth, int alpha, int beta, unsigned ply, bool on_pv) {
+	if (should_stop()) {
+		aborted = true;
+		return 0;
+	}
+
+	pv[ply].clear();
+	if (0 == depth) {
+		return rules_type::standard_lines ? evaluator.evaluate(current.current_player()) : 0;
+	}
+
+	const int original_alpha = alpha;
+	unsigned table_move = transposition_table::no_move;
+	transposition_table::entry entry;
+	if (table.probe(key(), entry)) {
+		table_move = entry.move;
+		// keep the principal variation intact by not cutting it short
+		if (!on_pv && depth <= entry.depth) {
+			const int value = value_from_table(entry.value, ply);
+			if (
+				entry.type == transposition_table::bound::exact ||
+				(entry.type == transposition_table::bound::lower && beta <= value) ||
+				(entry.type == transposition_table::bound::upper && value <= alpha)
+			) {
+				return value;
+			}
+		}
+	}
+
+	generate_moves(ply, on_pv, table_move);
+	const std::vector<field::size_type> &list = moves[ply];
+	if (list.empty()) {
+		return 0;
+	}
+
+	int best_value = -infinity;
+	field::size_type best_move = list.front();
+	for(const field::size_type move : list) {
+		pv[ply + 1].clear();
+		play(move);
+
+		int value;
+		switch(current.game_status()) {
+		case field_position::status::ongoing: {
+			const bool child_on_pv = on_pv && ply < previous_pv.size() && previous_pv[ply] == move;
+			value = -negamax(depth - 1, -beta, -alpha, ply + 1, child_on_pv);
+			break;
+		}
+		default: {
+			// the player that just moved is the opponent now
+			const field::tile mover = current.opponent_player();
+			const field::tile winner = rules::winner<rules_type>(mover, current.game_status());
+			value =
+				(winner == mover) ? win_value - static_cast<int>(ply + 1) :
+				(winner == field::tile::empty) ? 0 :
+				-win_value + static_cast<int>(ply + 1);
+			break;
+		}
+		}
+
+		take_back(move);
+		if (aborted) {
+			return 0;
+		}
+
+		if (best_value < value) {
+			best_value = value;
+			best_move = move;
+			if (alpha < value) {
+				alpha = value;
+				pv[ply].assign(1, move);
+				pv[ply].insert(pv[ply].end(), pv[ply + 1].begin(), pv[ply + 1].end());
+			}
+		}
+		if (beta <= alpha) {
+			break;
+		}
+	}
+
+	transposition_table::entry result;
+	result.value = value_to_table(best_value, ply);
+	result.depth = depth;
+	result.move = (best_move < transposition_table::no_move)
+		? static_cast<unsigned>(best_move)
+		: transposition_table::no_move;
+	result.type =
+		(best_value <= original_alpha) ? transposition_table::bound::upper :
+		(beta <= best_value) ? transposition_table::bound::lower :
+		transposition_table::bound::exact;
+	table.store(key(), result);
+	return best_value;
+}
+
+template<typename rules_type>
+void tictactoe::basic_searcher<rules_type>::play(field::size_type move) {
+	const field::size_type index = rules::move_index<rules_type>(move);
+	const field::tile state = rules::move_symbol<rules_type>(move, current.current_player());
+	if (rules_type::standard_lines) {
+		evaluator.make_move(index, state);
+	}
+	current.make_move(index, state);
+}
+
+template<typename rules_type>
+void tictactoe::basic_searcher<rules_type>::take_back(field::size_type move) {
+	current.unmake_move();
+	if (rules_type::standard_lines) {
+		evaluator.unmake_move(rules::move_index<rules_type>(move));
+	}
+}
+
+template struct tictactoe::basic_searcher<tictactoe::rules::standard>;
+template struct tictactoe::basic_searcher<tictactoe::rules::misere>;
+template struct tictactoe::basic_searcher<tictactoe::rules::wild>;
+template struct tictactoe::basic_searcher<tictactoe::rules::order_and_chaos>;
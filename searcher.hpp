@@ -0,0 +1,174 @@
+#ifndef TICTACTOE_SEARCHER_HPP_INCLUDED
+#define TICTACTOE_SEARCHER_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "field.hpp"
+#include "field_position.hpp"
+#include "pattern_evaluator.hpp"
+#include "rules.hpp"
+#include "transposition_table.hpp"
+
+namespace tictactoe {
+
+/**
+ * Limits for a single search.
+ */
+struct search_limits {
+	/**
+	 * Create limits that allow searching the whole game tree without any
+	 * time limit.
+	 */
+	search_limits();
+
+	/**
+	 * The depth of the first iteration in plies.
+	 */
+	unsigned start_depth;
+
+	/**
+	 * The maximum search depth in plies.
+	 */
+	unsigned max_depth;
+
+	/**
+	 * No new iteration is started and the current one is abandoned once this
+	 * point in time is reached. The first iteration is always completed.
+	 */
+	std::chrono::steady_clock::time_point deadline;
+
+	/**
+	 * If not nullptr, the search is cancelled as soon as the flag is set,
+	 * even during the first iteration. If no iteration was completed, the
+	 * result holds a legal move with depth 0.
+	 */
+	const std::atomic<bool> *stop;
+};
+
+/**
+ * The result of a search.
+ */
+struct search_result {
+	/**
+	 * The best move found by the deepest completed iteration, encoded as
+	 * described in rules.hpp; under the standard rules it is the flat index
+	 * of a tile.
+	 */
+	field::size_type move;
+
+	/**
+	 * The value of move from the point of view of the player to move. Values
+	 * beyond searcher::win_bound are forced wins, values below -win_bound
+	 * forced losses.
+	 */
+	int value;
+
+	/**
+	 * The depth of the deepest completed iteration.
+	 */
+	unsigned depth;
+
+	/**
+	 * The number of positions visited, including abandoned iterations.
+	 */
+	std::uint64_t nodes;
+
+	/**
+	 * The expected line of play, starting with move, encoded like move.
+	 */
+	std::vector<field::size_type> principal_variation;
+};
+
+/**
+ * An iterative deepening alpha-beta search over field positions of up to
+ * field_position::max_order and any win length.
+ * Each iteration is started with an aspiration window around the value of the
+ * previous one and tries the previous principal variation first.
+ * Positions are evaluated incrementally by a pattern_evaluator. Moves that
+ * lose at once are never searched when a win or block is possible, and on
+ * fields of order 9 and larger only moves near played tiles are searched.
+ *
+ * The rules are a template parameter, see rules.hpp, so the standard rules
+ * pay nothing for the variants. The patterns and the move pruning only apply
+ * to rules_type::standard_lines; other rules are searched over all moves and
+ * evaluated as 0 until the game is decided.
+ */
+template<typename rules_type>
+struct basic_searcher {
+	static constexpr int win_value = 10000;
+	static constexpr int win_bound = win_value - 1000;
+
+	/**
+	 * Create a searcher storing its results in the given table.
+	 */
+	explicit basic_searcher(transposition_table &table);
+
+	/**
+	 * Searches the best move.
+	 * \param position The position to search; it must have at least one
+	 *        empty tile and must not be won already.
+	 * \param current_player The state of the player to move.
+	 * \param limits The limits of the search.
+	 */
+	search_result search(const field &position, field::tile current_player, const search_limits &limits);
+
+	/**
+	 * Searches the best move, see search(const field &, field::tile, const search_limits &).
+	 * \param position The position to search; its game_status() has to be
+	 *        ongoing.
+	 */
+	search_result search(const field_position &position, const search_limits &limits);
+
+	/**
+	 * Returns the Zobrist hash of a position, see field_position::hash(),
+	 * combined with rules_type::hash_key.
+	 */
+	static std::uint64_t hash(const field &position, field::tile current_player);
+
+	/**
+	 * Returns a static evaluation of a position from the point of view of
+	 * current_player, counting the lines of win_length() tiles that are still
+	 * open for only one of the players. Without rules_type::standard_lines,
+	 * every position is evaluated as 0.
+	 */
+	static int evaluate(const field &position, field::tile current_player);
+
+	/**
+	 * Returns a static evaluation of a position from the point of view of the
+	 * player to move, see evaluate(const field &, field::tile).
+	 */
+	static int evaluate(const field_position &position);
+
+private:
+	int negamax(unsigned depth, int alpha, int beta, unsigned ply, bool on_pv);
+	bool should_stop();
+	void generate_moves(unsigned ply, bool on_pv, unsigned table_move);
+	void play(field::size_type move);
+	void take_back(field::size_type move);
+	std::uint64_t key() const noexcept { return current.hash() ^ rules_type::hash_key; }
+
+	transposition_table &table;
+	field_position current;
+	pattern_evaluator evaluator;
+	search_limits limits;
+	std::uint64_t nodes;
+	unsigned completed_depth;
+	bool aborted;
+
+	// all tiles ordered by their distance to the center
+	std::vector<field::size_type> move_order;
+	// move lists, one per ply, to avoid allocations during the search
+	std::vector<std::vector<field::size_type>> moves;
+	// triangular table of principal variations, one per ply
+	std::vector<std::vector<field::size_type>> pv;
+	std::vector<field::size_type> previous_pv;
+};
+
+typedef basic_searcher<rules::standard> searcher;
+
+}
+
+#endif // TICTACTOE_SEARCHER_HPP_INCLUDED
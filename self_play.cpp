@@ -0,0 +1,280 @@
+#include "self_play.hpp"
+
+#include <cassert>
+#include <cstring>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "game_records.hpp"
+#include "searcher.hpp"
+#include "symmetry.hpp"
+#include "transposition_table.hpp"
+#include "computer_state_table.inc"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef tictactoe::field::size_type size_type;
+
+	constexpr std::uint32_t num_3x3_codes = 19683; // 3^9
+
+	size_type random_empty_tile(const tictactoe::self_play_driver &games, std::size_t game, std::mt19937_64 &gen) {
+		const std::uint8_t *tiles = games.tiles(game);
+		size_type skip = std::uniform_int_distribution<size_type>(0, games.field_size() - games.moves_played(game) - 1)(gen);
+		for(size_type index = 0; ; ++index) {
+			if (tictactoe::field::tile::empty == static_cast<tictactoe::field::tile>(tiles[index]) && 0 == skip--) {
+				return index;
+			}
+		}
+	}
+
+	/**
+	 * Chooses a move like computer_player: win, block, look the position up
+	 * in the state table under all symmetries and finally search.
+	 */
+	size_type computer_move(const tictactoe::field &position, tictactoe::field::tile current_player, size_type occupied_tiles, tictactoe::searcher &engine) {
+		using namespace tictactoe;
+		const field::tile opponent_player = (current_player == field::tile::player1)
+			? field::tile::player2
+			: field::tile::player1;
+
+		for(const field::tile player : { current_player, opponent_player }) {
+			for(size_type index = 0; index < position.size(); ++index) {
+				if (position[index] == field::tile::empty && position.check_win_condition(index, player)) {
+					return index;
+				}
+			}
+		}
+
+		for(const auto &entry : computer_3x3_state_table::data) {
+			if (entry.occupied_tiles != occupied_tiles) {
+				continue;
+			}
+			for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+				size_type index;
+				for(index = 0; index < position.size(); ++index) {
+					if (position[symmetry::transform_index(3, index, transformation)] != entry.pattern[index]) {
+						break;
+					}
+				}
+				if (index == position.size()) {
+					return symmetry::transform_index(3, entry.next_move, transformation);
+				}
+			}
+		}
+
+		return engine.search(position, current_player, search_limits()).move;
+	}
+
+	/**
+	 * Returns the computer player's move for every 3x3 position by its base 3
+	 * code; unreachable and decided positions map to 0.
+	 */
+	const std::vector<std::uint8_t> &computer_moves() {
+		static const std::vector<std::uint8_t> moves = [] {
+			std::vector<std::uint8_t> result(num_3x3_codes, 0);
+			tictactoe::transposition_table table(16);
+			tictactoe::searcher engine(table);
+
+			for(std::uint32_t code = 0; code < num_3x3_codes; ++code) {
+				tictactoe::field position;
+				size_type tiles[3] = { 0, 0, 0 };
+				for(std::uint32_t index = 0, digits = code; index < position.size(); ++index, digits /= 3) {
+					position[index] = static_cast<tictactoe::field::tile>(digits % 3);
+					++tiles[digits % 3];
+				}
+
+				bool decided = 0 == tiles[0];
+				for(size_type index = 0; index < position.size() && !decided; ++index) {
+					decided = position[index] != tictactoe::field::tile::empty && position.check_win_condition(index);
+				}
+				if (decided || (tiles[1] != tiles[2] && tiles[1] != tiles[2] + 1)) {
+					continue;
+				}
+
+				const tictactoe::field::tile current_player = (tiles[1] == tiles[2])
+					? tictactoe::field::tile::player1
+					: tictactoe::field::tile::player2;
+				result[code] = static_cast<std::uint8_t>(computer_move(position, current_player, tiles[1] + tiles[2], engine));
+			}
+			return result;
+		}();
+		return moves;
+	}
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::random_policy
+//
+
+tictactoe::random_policy::random_policy(std::uint64_t seed)
+: gen(seed) {}
+
+void tictactoe::random_policy::choose_moves(const self_play_driver &games, std::uint8_t *moves) {
+	for(std::size_t game = 0; game < games.size(); ++game) {
+		moves[game] = static_cast<std::uint8_t>(random_empty_tile(games, game, gen));
+	}
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::table_policy
+//
+
+tictactoe::table_policy::table_policy(double exploration, std::uint64_t seed)
+: exploration(exploration)
+, gen(seed) {
+	computer_moves(); // build the table up front, not during the first step
+}
+
+void tictactoe::table_policy::choose_moves(const self_play_driver &games, std::uint8_t *moves) {
+	if (games.order() != 3 || games.win_length() != 3) {
+		throw std::invalid_argument("The table policy only plays 3x3 fields with 3 in a row.");
+	}
+
+	const std::vector<std::uint8_t> &table = computer_moves();
+	std::bernoulli_distribution explore(exploration);
+	for(std::size_t game = 0; game < games.size(); ++game) {
+		moves[game] = table[games.code(game)];
+	}
+	if (0 < exploration) {
+		for(std::size_t game = 0; game < games.size(); ++game) {
+			if (explore(gen)) {
+				moves[game] = static_cast<std::uint8_t>(random_empty_tile(games, game, gen));
+			}
+		}
+	}
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::self_play_driver
+//
+
+tictactoe::self_play_driver::self_play_driver(size_type order, size_type win_length, std::size_t batch_size)
+: field_order(order)
+, line_length(win_length ? win_length : order)
+, capacity(std::max<std::size_t>(1, batch_size))
+, active(0)
+, with_codes(order * order <= 20)
+, game_tiles(capacity * order * order)
+, game_histories(capacity * order * order)
+, game_codes(capacity)
+, game_moves(capacity)
+, chosen_moves(capacity)
+, powers_of_3(order * order, 0) {
+	assert(0 < order && order <= game_records::max_order && line_length <= order);
+	for(size_type index = 0, power = 1; with_codes && index < powers_of_3.size(); ++index, power *= 3) {
+		powers_of_3[index] = static_cast<std::uint32_t>(power);
+	}
+}
+
+tictactoe::self_play_statistics tictactoe::self_play_driver::run(self_play_policy &policy, std::uint64_t num_games, std::ostream *records) {
+	const clock_type::time_point start = clock_type::now();
+	const size_type size = field_size();
+	self_play_statistics stats = { 0, 0, 0, 0, 0, 0, std::chrono::duration<double>(0) };
+
+	std::uint64_t started = 0;
+	for(active = 0; active < capacity && started < num_games; ++active, ++started) {
+		start_game(active);
+	}
+
+	while(active) {
+		policy.choose_moves(*this, chosen_moves.data());
+		++stats.steps;
+
+		for(std::size_t game = 0; game < active; ) {
+			const size_type move = chosen_moves[game];
+			const field::tile state = current_player(game);
+			std::uint8_t &tile = game_tiles[game * size + move];
+			assert(move < size && static_cast<field::tile>(tile) == field::tile::empty);
+
+			tile = static_cast<std::uint8_t>(state);
+			game_histories[game * size + game_moves[game]++] = static_cast<std::uint8_t>(move);
+			game_codes[game] += powers_of_3[move] * static_cast<std::uint32_t>(state);
+			const bool won = completes_line(game, move);
+			if (!won && game_moves[game] < size) {
+				++game;
+				continue;
+			}
+
+			++stats.games;
+			stats.moves += game_moves[game];
+			if (!won) {
+				++stats.draws;
+			}
+			else if (state == field::tile::player1) {
+				++stats.player1_wins;
+			}
+			else {
+				++stats.player2_wins;
+			}
+			if (records) {
+				size_type history[256];
+				std::copy(&game_histories[game * size], &game_histories[game * size] + game_moves[game], history);
+				game_records::write_game(*records, history, game_moves[game]);
+			}
+
+			if (started < num_games) {
+				// the new game moves in the next step
+				start_game(game++);
+				++started;
+			}
+			else if (game != --active) {
+				// the last game has not moved yet in this step, so it moves
+				// in the freed slot now
+				move_game(active, game);
+				chosen_moves[game] = chosen_moves[active];
+			}
+		}
+	}
+
+	stats.elapsed = clock_type::now() - start;
+	return stats;
+}
+
+void tictactoe::self_play_driver::start_game(std::size_t game) {
+	std::memset(&game_tiles[game * field_size()], static_cast<int>(field::tile::empty), field_size());
+	game_codes[game] = 0;
+	game_moves[game] = 0;
+}
+
+void tictactoe::self_play_driver::move_game(std::size_t from, std::size_t to) {
+	std::memcpy(&game_tiles[to * field_size()], &game_tiles[from * field_size()], field_size());
+	std::memcpy(&game_histories[to * field_size()], &game_histories[from * field_size()], game_moves[from]);
+	game_codes[to] = game_codes[from];
+	game_moves[to] = game_moves[from];
+}
+
+bool tictactoe::self_play_driver::completes_line(std::size_t game, size_type index) const noexcept {
+	// see field_position::completes_line
+	const std::uint8_t *tiles = &game_tiles[game * field_size()];
+	const std::uint8_t state = tiles[index];
+	const int
+		order = static_cast<int>(field_order),
+		x = static_cast<int>(index) % order,
+		y = static_cast<int>(index) / order;
+	static const int directions[][2] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+	for(const auto &direction : directions) {
+		int length = 1;
+		for(int sign = -1; sign <= 1; sign += 2) {
+			const int dx = sign * direction[0], dy = sign * direction[1];
+			for(
+				int cx = x + dx, cy = y + dy;
+				0 <= cx && cx < order && 0 <= cy && cy < order && tiles[cy * order + cx] == state;
+				cx += dx, cy += dy
+			) {
+				++length;
+			}
+		}
+		if (static_cast<int>(line_length) <= length) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,173 @@
+#ifndef TICTACTOE_SELF_PLAY_HPP_INCLUDED
+#define TICTACTOE_SELF_PLAY_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "field.hpp"
+
+namespace tictactoe {
+
+struct self_play_driver;
+
+/**
+ * Chooses the moves of a whole batch of games at once.
+ */
+struct self_play_policy {
+	virtual ~self_play_policy() = default;
+
+	/**
+	 * Chooses the next move of every active game of the driver.
+	 * \param games The driver; all of its active games are ongoing.
+	 * \param moves Receives one legal flat tile index per active game.
+	 */
+	virtual void choose_moves(const self_play_driver &games, std::uint8_t *moves) = 0;
+};
+
+/**
+ * Plays a uniformly random empty tile.
+ */
+struct random_policy : self_play_policy {
+	explicit random_policy(std::uint64_t seed);
+
+	void choose_moves(const self_play_driver &games, std::uint8_t *moves) override;
+
+private:
+	std::mt19937_64 gen;
+};
+
+/**
+ * Plays like computer_player on a classic 3x3 field: every position is
+ * looked up in a table of the computer player's moves, which is built once
+ * from its win and block rules, its state table and, for the positions the
+ * state table does not cover, an exhaustive search.
+ */
+struct table_policy : self_play_policy {
+	/**
+	 * Create the policy.
+	 * \param exploration The probability of playing a random move instead,
+	 *        so self-play does not repeat the same game over and over.
+	 * \param seed The seed for the random moves.
+	 */
+	explicit table_policy(double exploration = 0, std::uint64_t seed = 0);
+
+	/**
+	 * \note Only 3x3 fields with 3 in a row are supported.
+	 */
+	void choose_moves(const self_play_driver &games, std::uint8_t *moves) override;
+
+private:
+	double exploration;
+	std::mt19937_64 gen;
+};
+
+/**
+ * Statistics of a self_play_driver::run().
+ */
+struct self_play_statistics {
+	std::uint64_t games;
+	std::uint64_t player1_wins;
+	std::uint64_t player2_wins;
+	std::uint64_t draws;
+	std::uint64_t moves;
+	/**
+	 * The number of batched policy calls.
+	 */
+	std::uint64_t steps;
+	std::chrono::duration<double> elapsed;
+
+	double games_per_second() const { return elapsed.count() > 0 ? games / elapsed.count() : 0; }
+};
+
+/**
+ * Advances many independent games in lockstep: each step asks the policy for
+ * the moves of all active games in a single call, then applies them.
+ * Finished games are replaced by new ones in place until no new games are
+ * left to start; then the active games are compacted at the front.
+ *
+ * The games are stored as a struct of arrays: the tiles of all games, the
+ * move histories of all games, the move counts of all games and so on each
+ * are a single array, indexed by the game's slot. Player 1 always moves
+ * first, so the player to move follows from the move count.
+ */
+struct self_play_driver {
+	typedef field::size_type size_type;
+
+	/**
+	 * Create a driver.
+	 * \param order The order of the field; at most 15.
+	 * \param win_length The number of tiles in a row needed to win; 0 means
+	 *        a full row.
+	 * \param batch_size The maximum number of games played at once.
+	 */
+	self_play_driver(size_type order, size_type win_length = 0, std::size_t batch_size = 4096);
+
+	/**
+	 * Plays games until a number of them have finished.
+	 * \param policy The policy choosing the moves for both players.
+	 * \param num_games The number of games to play.
+	 * \param records If not nullptr, every finished game is appended in the
+	 *        format of game_records.hpp; the header is left to the caller.
+	 */
+	self_play_statistics run(self_play_policy &policy, std::uint64_t num_games, std::ostream *records = nullptr);
+
+	// for policies
+
+	inline size_type order() const noexcept { return field_order; }
+	inline size_type win_length() const noexcept { return line_length; }
+	inline size_type field_size() const noexcept { return field_order * field_order; }
+
+	/**
+	 * Returns the number of active games.
+	 */
+	std::size_t size() const noexcept { return active; }
+
+	/**
+	 * Returns the tiles of an active game as field::tile values.
+	 */
+	const std::uint8_t *tiles(std::size_t game) const noexcept { return &game_tiles[game * field_size()]; }
+
+	/**
+	 * Returns the tiles of an active game as a base 3 number, the first tile
+	 * being the least significant digit. Only maintained on fields of up to
+	 * 20 tiles.
+	 */
+	std::uint32_t code(std::size_t game) const noexcept { return game_codes[game]; }
+
+	/**
+	 * Returns the number of moves played in an active game.
+	 */
+	size_type moves_played(std::size_t game) const noexcept { return game_moves[game]; }
+
+	/**
+	 * Returns the state of the player to move in an active game.
+	 */
+	field::tile current_player(std::size_t game) const noexcept {
+		return (game_moves[game] % 2) ? field::tile::player2 : field::tile::player1;
+	}
+
+private:
+	void start_game(std::size_t game);
+	void move_game(std::size_t from, std::size_t to);
+	bool completes_line(std::size_t game, size_type index) const noexcept;
+
+	size_type field_order;
+	size_type line_length;
+	std::size_t capacity;
+	std::size_t active;
+	bool with_codes;
+
+	std::vector<std::uint8_t> game_tiles;
+	std::vector<std::uint8_t> game_histories;
+	std::vector<std::uint32_t> game_codes;
+	std::vector<std::uint8_t> game_moves;
+	std::vector<std::uint8_t> chosen_moves;
+	std::vector<std::uint32_t> powers_of_3;
+};
+
+}
+
+#endif // TICTACTOE_SELF_PLAY_HPP_INCLUDED
@@ -0,0 +1,164 @@
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_records.hpp"
+#include "self_play.hpp"
+
+using namespace tictactoe;
+
+int main(int argc, const char * const argv[]) {
+	std::uint64_t num_games = 1000000, seed = 12345;
+	std::size_t batch_size = 4096;
+	field::size_type order = 3, win_length = 0;
+	unsigned threads = 1, exploration_percent = 10;
+	std::string policy_name = "table", output;
+	bool valid_options = true;
+
+	for(int arg = 1; arg < argc; arg += 2) {
+		const std::string option(argv[arg]);
+		const std::string text((arg + 1 < argc) ? argv[arg + 1] : "");
+		std::stringstream value(text);
+		unsigned long long number = 0;
+
+		if ("--policy" == option && ("table" == text || "random" == text)) {
+			policy_name = text;
+		}
+		else if ("--output" == option && !text.empty()) {
+			output = text;
+		}
+		else if (!(value >> number)) {
+			valid_options = false;
+		}
+		else if ("--games" == option) {
+			num_games = number;
+		}
+		else if ("--batch-size" == option && 0 < number) {
+			batch_size = number;
+		}
+		else if ("--order" == option && 0 < number && number <= game_records::max_order) {
+			order = number;
+		}
+		else if ("--win-length" == option) {
+			win_length = number;
+		}
+		else if ("--threads" == option && 0 < number) {
+			threads = number;
+		}
+		else if ("--exploration" == option && number <= 100) {
+			exploration_percent = number;
+		}
+		else if ("--seed" == option) {
+			seed = number;
+		}
+		else {
+			valid_options = false;
+		}
+	}
+	valid_options = valid_options && win_length <= order && ("random" == policy_name || (3 == order && (0 == win_length || 3 == win_length)));
+
+	if (!valid_options) {
+		std::cerr <<
+			"Usage:\n"
+			"\t" << argv[0] << " [<options>]\n"
+			"\n"
+			"Plays batches of games in lockstep and reports the throughput.\n"
+			"\n"
+			"--games <n>\n"
+			"\tThe number of games to play (default: 1000000).\n"
+			"--batch-size <n>\n"
+			"\tThe number of games played at once per thread (default: 4096).\n"
+			"--threads <n>\n"
+			"\tThe number of threads, each with its own batch (default: 1).\n"
+			"--order <n>\n"
+			"\tPlay on a field of n by n tiles, at most 15 (default: 3).\n"
+			"--win-length <k>\n"
+			"\tThe number of tiles in a row needed to win (default: a full row).\n"
+			"--policy table|random\n"
+			"\tPlay the computer player's moves on 3x3 fields or random moves\n"
+			"\t(default: table).\n"
+			"--exploration <percent>\n"
+			"\tThe share of random moves of the table policy (default: 10).\n"
+			"--seed <n>\n"
+			"\tThe seed for random moves (default: 12345).\n"
+			"--output <file>\n"
+			"\tWrite the games to a file in the format of game_records.hpp.\n";
+		return 1;
+	}
+
+	std::vector<self_play_statistics> stats(threads);
+	std::vector<std::stringstream> records(output.empty() ? 0 : threads);
+	const auto start = std::chrono::steady_clock::now();
+	try {
+		std::vector<std::thread> workers;
+		std::vector<std::exception_ptr> errors(threads);
+		for(unsigned thread = 0; thread < threads; ++thread) {
+			workers.emplace_back([&, thread] {
+				try {
+					std::unique_ptr<self_play_policy> policy(("table" == policy_name)
+						? static_cast<self_play_policy *>(new table_policy(exploration_percent / 100.0, seed + thread))
+						: static_cast<self_play_policy *>(new random_policy(seed + thread)));
+					self_play_driver driver(order, win_length, batch_size);
+					const std::uint64_t share = num_games / threads + (thread < num_games % threads);
+					stats[thread] = driver.run(*policy, share, records.empty() ? nullptr : &records[thread]);
+				}
+				catch(...) {
+					errors[thread] = std::current_exception();
+				}
+			});
+		}
+		for(auto &worker : workers) {
+			worker.join();
+		}
+		for(const auto &error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+
+		if (!output.empty()) {
+			std::ofstream file(output, std::ios::binary);
+			game_records::write_header(file, order, win_length);
+			for(const auto &thread_records : records) {
+				file << thread_records.rdbuf();
+			}
+			if (!file) {
+				throw std::runtime_error("Cannot write " + output + ".");
+			}
+		}
+	}
+	catch(std::exception &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return 1;
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	self_play_statistics total = { 0, 0, 0, 0, 0, 0, std::chrono::duration<double>(0) };
+	for(const auto &thread_stats : stats) {
+		total.games += thread_stats.games;
+		total.player1_wins += thread_stats.player1_wins;
+		total.player2_wins += thread_stats.player2_wins;
+		total.draws += thread_stats.draws;
+		total.moves += thread_stats.moves;
+		total.steps += thread_stats.steps;
+		total.elapsed += thread_stats.elapsed;
+	}
+
+	std::cout <<
+		"Games:          " << total.games << "\n"
+		"Player 1 wins:  " << total.player1_wins << "\n"
+		"Player 2 wins:  " << total.player2_wins << "\n"
+		"Draws:          " << total.draws << "\n"
+		"Moves:          " << total.moves << "\n"
+		"Policy calls:   " << total.steps << "\n"
+		"Games/s:        " << static_cast<std::uint64_t>(total.games / elapsed.count()) << "\n"
+		"Games/s/core:   " << static_cast<std::uint64_t>(total.elapsed.count() > 0 ? total.games / total.elapsed.count() : 0) << "\n";
+	return 0;
+}
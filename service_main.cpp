@@ -0,0 +1,89 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "evaluation_service.hpp"
+
+using namespace tictactoe;
+
+int main(int argc, const char * const argv[]) {
+	evaluation_service::settings settings;
+	bool valid_options = true;
+
+	for(int arg = 1; arg < argc; arg += 2) {
+		const std::string option(argv[arg]);
+		std::stringstream value((arg + 1 < argc) ? argv[arg + 1] : "");
+		unsigned long number = 0;
+
+		if (!(value >> number)) {
+			valid_options = false;
+		}
+		else if ("--threads" == option) {
+			settings.threads = number;
+		}
+		else if ("--depth" == option && 0 < number) {
+			settings.limits.max_depth = number;
+		}
+		else if ("--position-time" == option) {
+			settings.position_time = std::chrono::milliseconds(number);
+		}
+		else if ("--batch-size" == option && 0 < number) {
+			settings.max_batch_size = number;
+		}
+		else if ("--batch-window" == option) {
+			settings.batch_window = std::chrono::microseconds(number);
+		}
+		else {
+			valid_options = false;
+		}
+	}
+
+	if (!valid_options) {
+		std::cerr <<
+			"Usage:\n"
+			"\t" << argv[0] << " [<options>] < queries > answers\n"
+			"\n"
+			"Reads evaluation queries from stdin and writes the answers to\n"
+			"stdout, both in the binary format described in\n"
+			"evaluation_service.hpp. Statistics are written to stderr.\n"
+			"\n"
+			"--threads <n>\n"
+			"\tThe number of worker threads (default: one per hardware thread).\n"
+			"--depth <n>\n"
+			"\tThe maximum search depth (default: unlimited).\n"
+			"--position-time <ms>\n"
+			"\tThe time limit for each position (default: none for fields up to\n"
+			"\t4x4; 1000 for larger fields unless --depth is given).\n"
+			"--batch-size <n>\n"
+			"\tThe maximum number of queries per batch (default: 4096).\n"
+			"--batch-window <us>\n"
+			"\tThe time to wait for more queries before a batch is evaluated\n"
+			"\t(default: 1000).\n";
+		return 1;
+	}
+
+	std::ios::sync_with_stdio(false);
+	evaluation_service service(settings);
+	try {
+		service.run(std::cin, std::cout);
+	}
+	catch(std::runtime_error &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return 1;
+	}
+
+	const evaluation_service::statistics &stats = service.stats();
+	std::cerr <<
+		"Queries:     " << stats.queries << "\n"
+		"Batches:     " << stats.batches << "\n"
+		"Evaluations: " << stats.evaluations << "\n"
+		"Cache hits:  " << stats.cache_hits << "\n"
+		"Throughput:  " << static_cast<std::uint64_t>(stats.queries_per_second()) << " queries/s\n"
+		"Batch latency (p50 / p99 / max): " <<
+			stats.batch_latency(50).count() * 1000 << "ms / " <<
+			stats.batch_latency(99).count() * 1000 << "ms / " <<
+			stats.batch_latency(100).count() * 1000 << "ms\n";
+	return 0;
+}
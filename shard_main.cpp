@@ -0,0 +1,136 @@
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "field_position.hpp"
+#include "sharding.hpp"
+
+using namespace tictactoe;
+
+int main(int argc, const char * const argv[]) {
+#ifdef _WIN32
+	// Workaround for Windows: no fork and no socket pairs, so no workers
+	std::cerr << "Error: " << argv[0] << " is not supported on Windows.\n";
+	return 1;
+#else
+	shard_job job;
+	shard_coordinator::settings settings;
+	bool valid_options = true;
+
+	if (2 == argc && std::string("--worker") == argv[1]) {
+		return serve_shards(0, 1) ? 0 : 1;
+	}
+
+	for(int arg = 1; arg < argc; arg += 2) {
+		const std::string option(argv[arg]);
+		const std::string text((arg + 1 < argc) ? argv[arg + 1] : "");
+		std::stringstream value(text);
+		unsigned long long number = 0;
+
+		if ("--job" == option && ("patterns" == text || "random" == text)) {
+			job.type = ("patterns" == text) ? shard_job::kind::patterns : shard_job::kind::random;
+		}
+		else if ("--worker-command" == option && !text.empty()) {
+			settings.worker_command = text;
+		}
+		else if (!(value >> number)) {
+			valid_options = false;
+		}
+		else if ("--workers" == option && 0 < number) {
+			settings.workers = number;
+		}
+		else if ("--shard-size" == option) {
+			settings.shard_size = number;
+		}
+		else if ("--speculate" == option && number <= 1) {
+			settings.speculate = (1 == number);
+		}
+		else if ("--games" == option) {
+			job.games = number;
+		}
+		else if ("--order" == option && 0 < number && number <= field_position::max_order) {
+			job.order = number;
+		}
+		else if ("--win-length" == option) {
+			job.win_length = number;
+		}
+		else if ("--depth" == option && 0 < number) {
+			job.depth = number;
+		}
+		else {
+			valid_options = false;
+		}
+	}
+	valid_options = valid_options && job.win_length <= job.order;
+
+	if (!valid_options) {
+		std::cerr <<
+			"Usage:\n"
+			"\t" << argv[0] << " [<options>]\n"
+			"\t" << argv[0] << " --worker\n"
+			"\n"
+			"Plays a run of games split into shards on worker processes and\n"
+			"reports the merged results. With --worker, plays the shards read\n"
+			"from standard input instead.\n"
+			"\n"
+			"--job patterns|random\n"
+			"\tThe computer player against the pattern players of the tests, or\n"
+			"\ta search player against random players (default: patterns).\n"
+			"--workers <n>\n"
+			"\tThe number of workers (default: one per hardware thread).\n"
+			"--worker-command <command>\n"
+			"\tStart workers with a shell command, e.g.\n"
+			"\t\"ssh node2 ./shardtictactoe --worker\" (default: fork them).\n"
+			"--shard-size <n>\n"
+			"\tThe number of games per shard (default: about 8 shards per worker).\n"
+			"--speculate 0|1\n"
+			"\tWhether idle workers run copies of straggling shards (default: 1).\n"
+			"--games <n>\n"
+			"\tThe number of random games (default: 1000).\n"
+			"--order <n>\n"
+			"\tPlay random games on a field of n by n tiles (default: 3).\n"
+			"--win-length <k>\n"
+			"\tThe number of tiles in a row needed to win (default: a full row).\n"
+			"--depth <n>\n"
+			"\tThe search depth of the search player (default: 1).\n";
+		return 1;
+	}
+
+	shard_coordinator coordinator(settings);
+	shard_result result;
+	try {
+		result = coordinator.run(job);
+	}
+	catch(std::exception &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		return 1;
+	}
+
+	const shard_coordinator::statistics &stats = coordinator.stats();
+	std::cout <<
+		"Games:          " << result.games << "\n"
+		"Wins:           " << result.wins << "\n"
+		"Draws:          " << result.draws << "\n"
+		"Losses:         " << result.losses << "\n"
+		"Shards:         " << stats.shards << " (" << stats.dispatched << " dispatched, " <<
+			stats.speculated << " speculative, " << stats.discarded << " discarded)\n"
+		"Failed workers: " << stats.failed_workers << "\n"
+		"Shards/worker: ";
+	for(const std::uint64_t shards : stats.worker_shards) {
+		std::cout << ' ' << shards;
+	}
+	std::cout << "\n"
+		"Time:           " << std::fixed << std::setprecision(3) << stats.elapsed.count() << "s\n";
+
+	for(const loss_report &report : result.loss_reports) {
+		std::cout << "Lost game " << report.unit << ':';
+		for(const field::size_type move : report.moves) {
+			std::cout << ' ' << move;
+		}
+		std::cout << '\n';
+	}
+	return 0;
+#endif
+}
@@ -0,0 +1,577 @@
+#include "sharding.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <poll.h>
+#	include <signal.h>
+#	include <sys/socket.h>
+#	include <sys/wait.h>
+#	include <unistd.h>
+#endif
+
+#include "computer_player.hpp"
+#include "game.hpp"
+#include "pattern_player.hpp"
+#include "simulation.hpp"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	const std::vector<tictactoe::field::size_type>
+		first_pattern = { 9, 7, 5, 3, 1 },
+		second_pattern = { 8, 6, 4, 2 };
+	// the number of games with each pattern: the product of its entries
+	constexpr std::uint64_t first_pattern_units = 945, second_pattern_units = 384;
+
+	/**
+	 * Wraps a player and appends its moves to a game record.
+	 */
+	struct recording_player : tictactoe::player {
+		recording_player(tictactoe::player &wrapped, std::vector<tictactoe::field::size_type> &moves)
+		: wrapped(wrapped)
+		, moves(moves) {}
+
+		std::string name() const override {
+			return wrapped.name();
+		}
+
+		void make_move(tictactoe::game_make_move_interface game_interface) override {
+			const tictactoe::field before = game_interface.field();
+			wrapped.make_move(game_interface);
+			for(tictactoe::field::size_type index = 0; index < before.size(); ++index) {
+				if (before[index] != game_interface.field()[index]) {
+					moves.push_back(index);
+				}
+			}
+		}
+
+		tictactoe::player &wrapped;
+		std::vector<tictactoe::field::size_type> &moves;
+	};
+
+	/**
+	 * The same for simulation players.
+	 */
+	template<typename wrapped_type>
+	struct recording_simulation_player {
+		void make_move(tictactoe::simulation::move_interface &game) {
+			wrapped.make_move(game);
+			if (game.has_moved()) {
+				moves.push_back(game.position().last_move());
+			}
+		}
+
+		wrapped_type &wrapped;
+		std::vector<tictactoe::field::size_type> &moves;
+	};
+
+#ifndef _WIN32
+#ifdef MSG_NOSIGNAL
+	constexpr int no_sigpipe = MSG_NOSIGNAL;
+#else
+	constexpr int no_sigpipe = 0; // SO_NOSIGPIPE is set on the sockets instead
+#endif
+
+	/**
+	 * Swallows everything game() prints.
+	 */
+	struct null_buffer : std::streambuf {
+		int_type overflow(int_type c) override {
+			return traits_type::not_eof(c);
+		}
+	};
+
+	const char *kind_name(tictactoe::shard_job::kind type) {
+		return (type == tictactoe::shard_job::kind::patterns) ? "patterns" : "random";
+	}
+
+	bool write_all(int output, const std::string &text) {
+		for(std::size_t written = 0; written < text.size(); ) {
+			const ssize_t length = write(output, text.data() + written, text.size() - written);
+			if (length < 0 && EINTR != errno) {
+				return false;
+			}
+			written += (0 < length) ? length : 0;
+		}
+		return true;
+	}
+
+	/**
+	 * Splits the complete lines off a buffer of received text.
+	 */
+	bool next_line(std::string &buffer, std::string &line) {
+		const std::size_t end = buffer.find('\n');
+		if (end == std::string::npos) {
+			return false;
+		}
+		line = buffer.substr(0, end);
+		buffer.erase(0, end + 1);
+		return true;
+	}
+
+	struct shard_state {
+		std::uint64_t first;
+		std::uint64_t last;
+		/**
+		 * The number of workers playing the shard.
+		 */
+		unsigned running;
+		unsigned failures;
+		bool done;
+		clock_type::time_point started;
+	};
+
+	struct worker_process {
+		pid_t pid;
+		int socket;
+		std::size_t index;
+		std::string input;
+		/**
+		 * The shard being played, or -1 while idle.
+		 */
+		long shard;
+		tictactoe::shard_result partial;
+	};
+
+	/**
+	 * The workers of a run; stopped on destruction, even if the run fails.
+	 */
+	struct worker_pool {
+		~worker_pool() {
+			for(const worker_process &worker : workers) {
+				stop(worker);
+			}
+		}
+
+		/**
+		 * Closes the socket of a worker and waits for it to exit. Idle
+		 * workers exit by themselves, busy ones are terminated.
+		 */
+		static void stop(const worker_process &worker) {
+			if (0 <= worker.shard) {
+				kill(worker.pid, SIGTERM);
+			}
+			close(worker.socket);
+			while(waitpid(worker.pid, nullptr, 0) < 0 && EINTR == errno) {}
+		}
+
+		void start(const std::string &command, std::size_t index) {
+			int sockets[2];
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets)) {
+				throw std::runtime_error("Cannot create a socket for a worker.");
+			}
+			fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+			fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+			const int enabled = 1;
+			setsockopt(sockets[0], SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+
+			// anything still buffered would be printed by the worker, too
+			std::cout.flush();
+			std::cerr.flush();
+			const pid_t pid = fork();
+			if (pid < 0) {
+				close(sockets[0]);
+				close(sockets[1]);
+				throw std::runtime_error("Cannot start a worker.");
+			}
+			if (0 == pid) {
+				// the worker only ever leaves through _exit, an exception must
+				// not unwind into the coordinator's code
+				try {
+					close(sockets[0]);
+					if (command.empty()) {
+						for(const worker_process &worker : workers) {
+							close(worker.socket);
+						}
+						_exit(tictactoe::serve_shards(sockets[1], sockets[1]) ? 0 : 1);
+					}
+					dup2(sockets[1], 0);
+					dup2(sockets[1], 1);
+					execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
+				}
+				catch(...) {
+					_exit(1);
+				}
+				_exit(127);
+			}
+
+			close(sockets[1]);
+			worker_process worker;
+			worker.pid = pid;
+			worker.socket = sockets[0];
+			worker.index = index;
+			worker.shard = -1;
+			workers.push_back(worker);
+		}
+
+		std::vector<worker_process> workers;
+	};
+#endif
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::shard_job, tictactoe::shard_result
+//
+
+tictactoe::shard_job::shard_job()
+: type(kind::patterns)
+, order(3)
+, win_length(0)
+, depth(1)
+, games(1000) {}
+
+std::uint64_t tictactoe::shard_job::units() const {
+	return (type == kind::patterns)
+		? first_pattern_units + second_pattern_units
+		: games;
+}
+
+tictactoe::shard_result::shard_result()
+: games(0)
+, wins(0)
+, draws(0)
+, losses(0) {}
+
+void tictactoe::shard_result::merge(const shard_result &other) {
+	games += other.games;
+	wins += other.wins;
+	draws += other.draws;
+	losses += other.losses;
+
+	const std::size_t merged = loss_reports.size();
+	loss_reports.insert(loss_reports.end(), other.loss_reports.begin(), other.loss_reports.end());
+	std::inplace_merge(
+		loss_reports.begin(), loss_reports.begin() + merged, loss_reports.end(),
+		[](const loss_report &lhs, const loss_report &rhs) {
+			return lhs.unit < rhs.unit;
+		}
+	);
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// workers
+//
+
+tictactoe::shard_result tictactoe::run_shard(const shard_job &job, std::uint64_t first, std::uint64_t last) {
+	shard_result result;
+	for(std::uint64_t unit = first; unit < last; ++unit) {
+		std::vector<field::size_type> moves;
+		field::tile winner, tested_player;
+
+		if (job.type == shard_job::kind::patterns) {
+			const bool pattern_first = unit < first_pattern_units;
+			pattern_player tester(
+				pattern_first ? first_pattern : second_pattern,
+				pattern_first ? unit : unit - first_pattern_units
+			);
+			computer_player computer;
+			recording_player recorded_tester(tester, moves), recorded_computer(computer, moves);
+			const player *winning_player = pattern_first
+				? game(recorded_tester, recorded_computer)
+				: game(recorded_computer, recorded_tester);
+
+			tested_player = pattern_first ? field::tile::player2 : field::tile::player1;
+			winner =
+				(winning_player == &recorded_computer) ? tested_player :
+				(winning_player == &recorded_tester) ? ((tested_player == field::tile::player1) ? field::tile::player2 : field::tile::player1) :
+				field::tile::empty;
+		}
+		else {
+			simulation::random_player random_moves(unit);
+			simulation::search_player engine(job.depth);
+			recording_simulation_player<simulation::random_player> recorded_random = { random_moves, moves };
+			recording_simulation_player<simulation::search_player> recorded_engine = { engine, moves };
+			game_settings settings;
+			settings.order = job.order;
+			settings.win_length = job.win_length;
+
+			const bool engine_first = 0 == unit % 2;
+			tested_player = engine_first ? field::tile::player1 : field::tile::player2;
+			winner = engine_first
+				? simulation::game(recorded_engine, recorded_random, settings)
+				: simulation::game(recorded_random, recorded_engine, settings);
+		}
+
+		++result.games;
+		if (winner == tested_player) {
+			++result.wins;
+		}
+		else if (winner == field::tile::empty) {
+			++result.draws;
+		}
+		else {
+			++result.losses;
+			const loss_report report = { unit, moves };
+			result.loss_reports.push_back(report);
+		}
+	}
+	return result;
+}
+
+#ifndef _WIN32
+bool tictactoe::serve_shards(int input, int output) {
+	null_buffer discarded;
+	std::streambuf * const console = std::cout.rdbuf(&discarded);
+
+	std::string buffer, line;
+	bool valid = true;
+	for(char received[4096]; valid; ) {
+		if (!next_line(buffer, line)) {
+			const ssize_t length = read(input, received, sizeof(received));
+			if (length < 0 && EINTR == errno) {
+				continue;
+			}
+			if (length <= 0) {
+				break;
+			}
+			buffer.append(received, length);
+			continue;
+		}
+
+		std::stringstream request(line);
+		std::string command, kind;
+		std::uint64_t id, order, win_length, depth, first, last;
+		shard_job job;
+		valid =
+			request >> command >> id >> kind >> order >> win_length >> depth >> first >> last &&
+			"shard" == command && ("patterns" == kind || "random" == kind) &&
+			0 < order && order <= field_position::max_order && win_length <= order;
+		if (!valid) {
+			break;
+		}
+		job.type = ("patterns" == kind) ? shard_job::kind::patterns : shard_job::kind::random;
+		job.order = order;
+		job.win_length = win_length;
+		job.depth = depth;
+		job.games = last;
+		valid = first <= last && last <= job.units();
+		if (!valid) {
+			break;
+		}
+
+		const shard_result result = run_shard(job, first, last);
+		std::stringstream reply;
+		for(const loss_report &report : result.loss_reports) {
+			reply << "loss " << report.unit;
+			const char *separator = " ";
+			for(const field::size_type move : report.moves) {
+				reply << separator << move;
+				separator = ",";
+			}
+			reply << '\n';
+		}
+		reply << "done " << id << ' ' << result.games << ' ' << result.wins << ' ' << result.draws << ' ' << result.losses << '\n';
+		if (!write_all(output, reply.str())) {
+			break;
+		}
+	}
+
+	std::cout.rdbuf(console);
+	return valid;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::shard_coordinator
+//
+
+tictactoe::shard_coordinator::settings::settings()
+: workers(std::max(1u, std::thread::hardware_concurrency()))
+, shard_size(0)
+, speculate(true)
+, max_retries(3) {}
+
+tictactoe::shard_coordinator::shard_coordinator(const settings &coordinator_settings)
+: config(coordinator_settings)
+, statistic() {}
+
+tictactoe::shard_result tictactoe::shard_coordinator::run(const shard_job &job) {
+	const clock_type::time_point start = clock_type::now();
+	const unsigned num_workers = std::max(1u, config.workers);
+	const std::uint64_t
+		units = job.units(),
+		shard_size = config.shard_size ? config.shard_size : std::max<std::uint64_t>(1, (units + 8 * num_workers - 1) / (8 * num_workers));
+
+	std::vector<shard_state> shards;
+	std::deque<std::size_t> pending;
+	for(std::uint64_t first = 0; first < units; first += shard_size) {
+		const shard_state shard = { first, std::min(units, first + shard_size), 0, 0, false, clock_type::time_point() };
+		pending.push_back(shards.size());
+		shards.push_back(shard);
+	}
+	statistic = statistics();
+	statistic.shards = shards.size();
+	statistic.worker_shards.assign(num_workers, 0);
+
+	worker_pool pool;
+	for(unsigned index = 0; index < num_workers; ++index) {
+		pool.start(config.worker_command, index);
+	}
+	std::vector<worker_process> &workers = pool.workers;
+
+	// the shard of a failed worker is handed out again, unless another
+	// copy of it is still running
+	auto fail = [&](std::size_t index) {
+		const long shard = workers[index].shard;
+		worker_pool::stop(workers[index]);
+		workers.erase(workers.begin() + index);
+		++statistic.failed_workers;
+		if (0 <= shard && 0 == --shards[shard].running && !shards[shard].done) {
+			if (config.max_retries < ++shards[shard].failures) {
+				throw std::runtime_error("A shard keeps failing.");
+			}
+			pending.push_front(shard);
+		}
+	};
+
+	shard_result result;
+	std::size_t finished = 0;
+	std::vector<pollfd> polled;
+	while(finished < shards.size()) {
+		for(std::size_t index = 0; index < workers.size(); ) {
+			worker_process &worker = workers[index];
+			long shard = -1;
+			if (0 <= worker.shard) {
+				++index;
+				continue;
+			}
+			else if (!pending.empty()) {
+				shard = pending.front();
+				pending.pop_front();
+			}
+			else if (config.speculate) {
+				// the longest running shard without a copy yet
+				for(std::size_t candidate = 0; candidate < shards.size(); ++candidate) {
+					if (
+						!shards[candidate].done && 1 == shards[candidate].running &&
+						(shard < 0 || shards[candidate].started < shards[shard].started)
+					) {
+						shard = candidate;
+					}
+				}
+				statistic.speculated += (0 <= shard);
+			}
+			if (shard < 0) {
+				++index;
+				continue;
+			}
+
+			std::stringstream request;
+			request <<
+				"shard " << shard << ' ' << kind_name(job.type) << ' ' << job.order << ' ' << job.win_length << ' ' <<
+				job.depth << ' ' << shards[shard].first << ' ' << shards[shard].last << '\n';
+			const std::string text = request.str();
+			if (0 == shards[shard].running++) {
+				shards[shard].started = clock_type::now();
+			}
+			worker.shard = shard;
+			++statistic.dispatched;
+			if (send(worker.socket, text.data(), text.size(), no_sigpipe) != static_cast<ssize_t>(text.size())) {
+				fail(index);
+				continue;
+			}
+			++index;
+		}
+
+		if (workers.empty()) {
+			throw std::runtime_error("All workers have failed.");
+		}
+		polled.clear();
+		for(const worker_process &worker : workers) {
+			polled.push_back(pollfd { worker.socket, POLLIN, 0 });
+		}
+		if (poll(polled.data(), polled.size(), -1) < 0) {
+			continue;
+		}
+
+		for(std::size_t index = polled.size(); 0 < index--; ) {
+			if (!polled[index].revents) {
+				continue;
+			}
+			worker_process &worker = workers[index];
+			char received[4096];
+			const ssize_t length = recv(worker.socket, received, sizeof(received), 0);
+			if (length < 0 && EINTR == errno) {
+				continue;
+			}
+			if (length <= 0) {
+				fail(index);
+				continue;
+			}
+			worker.input.append(received, length);
+
+			bool valid = true;
+			for(std::string line; valid && next_line(worker.input, line); ) {
+				std::stringstream reply(line);
+				std::string command;
+				reply >> command;
+				if ("loss" == command) {
+					loss_report report;
+					std::string moves, move;
+					valid = static_cast<bool>(reply >> report.unit >> moves);
+					std::stringstream move_list(moves);
+					while(valid && std::getline(move_list, move, ',')) {
+						std::stringstream move_value(move);
+						field::size_type index;
+						valid = static_cast<bool>(move_value >> index);
+						report.moves.push_back(index);
+					}
+					worker.partial.loss_reports.push_back(report);
+				}
+				else if ("done" == command) {
+					long shard;
+					shard_result &partial = worker.partial;
+					valid =
+						reply >> shard >> partial.games >> partial.wins >> partial.draws >> partial.losses &&
+						shard == worker.shard;
+					if (!valid) {
+						break;
+					}
+
+					--shards[shard].running;
+					if (shards[shard].done) {
+						++statistic.discarded;
+					}
+					else {
+						shards[shard].done = true;
+						result.merge(partial);
+						++finished;
+						++statistic.worker_shards[worker.index];
+					}
+					worker.shard = -1;
+					partial = shard_result();
+				}
+				else {
+					valid = false;
+				}
+			}
+			if (!valid) {
+				fail(index);
+			}
+		}
+	}
+
+	statistic.elapsed = clock_type::now() - start;
+	return result;
+}
+
+const tictactoe::shard_coordinator::statistics &tictactoe::shard_coordinator::stats() const {
+	return statistic;
+}
+#endif
@@ -0,0 +1,207 @@
+#ifndef TICTACTOE_SHARDING_HPP_INCLUDED
+#define TICTACTOE_SHARDING_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "field.hpp"
+
+namespace tictactoe {
+
+/**
+ * A run of games split into independent units, each a single game that only
+ * depends on its unit number. Any range of units can be played anywhere and
+ * the results merged.
+ */
+struct shard_job {
+	enum class kind {
+		/**
+		 * The computer player against the pattern players of the tests:
+		 * units 0 - 944 let a pattern_player following {9, 7, 5, 3, 1}
+		 * seeded with the unit number move first, the following 384 units
+		 * the computer, against the pattern {8, 6, 4, 2}.
+		 */
+		patterns,
+		/**
+		 * A search player limited to a search depth against a random player
+		 * seeded with the unit number; the search player moves first in
+		 * even units.
+		 */
+		random
+	};
+
+	/**
+	 * Create a job for the pattern games.
+	 */
+	shard_job();
+
+	kind type;
+	/**
+	 * The field for random games.
+	 */
+	field::size_type order;
+	field::size_type win_length;
+	/**
+	 * The search depth of the search player in random games.
+	 */
+	unsigned depth;
+	/**
+	 * The number of random games.
+	 */
+	std::uint64_t games;
+
+	/**
+	 * Returns the number of units of the job.
+	 */
+	std::uint64_t units() const;
+};
+
+/**
+ * A game lost by the player under test.
+ */
+struct loss_report {
+	std::uint64_t unit;
+	/**
+	 * The moves of the game as flat tile indices.
+	 */
+	std::vector<field::size_type> moves;
+};
+
+/**
+ * The results of a range of units, from the point of view of the player
+ * under test: the computer player or the search player.
+ */
+struct shard_result {
+	shard_result();
+
+	std::uint64_t games;
+	std::uint64_t wins;
+	std::uint64_t draws;
+	std::uint64_t losses;
+	/**
+	 * The lost games, ordered by unit.
+	 */
+	std::vector<loss_report> loss_reports;
+
+	/**
+	 * Adds the results of other units.
+	 */
+	void merge(const shard_result &other);
+};
+
+/**
+ * Plays a range of units of a job in this process.
+ * \param first The first unit.
+ * \param last The unit after the last one.
+ */
+shard_result run_shard(const shard_job &job, std::uint64_t first, std::uint64_t last);
+
+#ifndef _WIN32
+/**
+ * Plays the shards a coordinator sends until the input ends, see
+ * shard_coordinator. Anything printed to std::cout meanwhile is discarded.
+ * Not available on Windows.
+ * \param input The descriptor the shards are read from.
+ * \param output The descriptor the results are written to.
+ * \return false if the input was malformed.
+ */
+bool serve_shards(int input, int output);
+
+/**
+ * Splits a job into shards and plays them on worker processes.
+ *
+ * Workers are either forked from this process or started with a shell
+ * command, e.g. "ssh node2 ./shardtictactoe --worker", so they can run on
+ * other machines. The coordinator talks to each worker over a socket or the
+ * command's standard input and output, in lines of text:
+ *   shard <id> patterns|random <order> <win_length> <depth> <first> <last>
+ * is answered with
+ *   loss <unit> <move>,<move>,...   for every lost game, then
+ *   done <id> <games> <wins> <draws> <losses>
+ *
+ * Shards are handed out one at a time, so faster workers take more of them.
+ * Once no shards are left to hand out, idle workers run copies of the shards
+ * still in progress and whichever copy finishes first counts, so a straggling
+ * worker does not hold up the whole run. Shards of failed workers are handed
+ * out again. Not available on Windows.
+ */
+struct shard_coordinator {
+	struct settings {
+		/**
+		 * Create the default settings: one forked worker per hardware
+		 * thread, about 8 shards per worker and copies of straggling shards.
+		 */
+		settings();
+
+		unsigned workers;
+		/**
+		 * The number of units per shard; 0 picks a size that makes about 8
+		 * shards per worker.
+		 */
+		std::uint64_t shard_size;
+		/**
+		 * The shell command starting a worker, or empty to fork workers
+		 * from this process.
+		 */
+		std::string worker_command;
+		/**
+		 * Whether idle workers run copies of the shards still in progress.
+		 */
+		bool speculate;
+		/**
+		 * The number of times a shard is handed out again after its workers
+		 * failed before the run is given up.
+		 */
+		unsigned max_retries;
+	};
+
+	struct statistics {
+		std::uint64_t shards;
+		/**
+		 * The number of shards sent to workers, including copies and
+		 * retries.
+		 */
+		std::uint64_t dispatched;
+		/**
+		 * The number of copies of shards in progress sent to idle workers.
+		 */
+		std::uint64_t speculated;
+		/**
+		 * The number of results discarded because another copy of their
+		 * shard had finished first.
+		 */
+		std::uint64_t discarded;
+		std::uint64_t failed_workers;
+		/**
+		 * The number of shards finished per worker.
+		 */
+		std::vector<std::uint64_t> worker_shards;
+		std::chrono::duration<double> elapsed;
+	};
+
+	explicit shard_coordinator(const settings &coordinator_settings = settings());
+
+	/**
+	 * Plays all units of a job on the workers and merges the results. The
+	 * workers are started for this run and stopped afterwards.
+	 * \throw std::runtime_error if no worker can be started, all workers
+	 *        have failed or a shard keeps failing.
+	 */
+	shard_result run(const shard_job &job);
+
+	/**
+	 * Returns the statistics of the last run.
+	 */
+	const statistics &stats() const;
+
+private:
+	settings config;
+	statistics statistic;
+};
+#endif
+
+}
+
+#endif // TICTACTOE_SHARDING_HPP_INCLUDED
@@ -0,0 +1,12 @@
+#include "simulation.hpp"
+
+template<typename rules_type>
+tictactoe::simulation::basic_search_player<rules_type>::basic_search_player(unsigned max_depth, unsigned table_size_log2)
+: max_depth(max_depth)
+, table(table_size_log2)
+, engine(table) {}
+
+template struct tictactoe::simulation::basic_search_player<tictactoe::rules::standard>;
+template struct tictactoe::simulation::basic_search_player<tictactoe::rules::misere>;
+template struct tictactoe::simulation::basic_search_player<tictactoe::rules::wild>;
+template struct tictactoe::simulation::basic_search_player<tictactoe::rules::order_and_chaos>;
@@ -0,0 +1,301 @@
+#ifndef TICTACTOE_SIMULATION_HPP_INCLUDED
+#define TICTACTOE_SIMULATION_HPP_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+
+#include "field.hpp"
+#include "field_position.hpp"
+#include "game.hpp"
+#include "player.hpp"
+#include "rules.hpp"
+#include "searcher.hpp"
+#include "transposition_table.hpp"
+
+namespace tictactoe {
+/**
+ * A statically dispatched variant of game() for simulations and tests.
+ *
+ * simulation::game() is a template over the player types, so each move is a
+ * direct call the compiler can inline. The players see the field through a
+ * move_interface over a field_position: no virtual calls, no std::function
+ * and no bounds checked field access per move, and nothing is printed.
+ *
+ * A player type only needs a member function
+ *   void make_move(simulation::move_interface &game);
+ * which commits exactly one move through game.make_move().
+ *
+ * The rules are the first template parameter, see rules.hpp; players of a
+ * variant take a basic_move_interface of its rules instead.
+ */
+namespace simulation {
+	/**
+	 * The counterpart of game_make_move_interface for simulation::game().
+	 */
+	template<typename rules_type>
+	struct basic_move_interface {
+		typedef std::chrono::steady_clock clock_type;
+		typedef rules_type rules;
+
+		/**
+		 * Create an interface for the player to move in a position.
+		 * \param deadline The point in time the move has to be committed by.
+		 */
+		basic_move_interface(field_position &position, clock_type::time_point deadline = clock_type::time_point::max()) noexcept
+		: current(position)
+		, move_deadline(deadline)
+		, moved(false) {}
+
+		/**
+		 * Returns the state of a tile. The index is not checked.
+		 */
+		field::tile operator[](field::size_type index) const noexcept { return current[index]; }
+
+		/**
+		 * The position that is played on.
+		 */
+		const field_position &position() const noexcept { return current; }
+
+		field::tile current_player() const noexcept { return current.current_player(); }
+		field::tile opponent_player() const noexcept { return current.opponent_player(); }
+
+		/**
+		 * See game_make_move_interface::deadline().
+		 */
+		clock_type::time_point deadline() const noexcept { return move_deadline; }
+
+		/**
+		 * Returns whether the deadline has passed. Unlike
+		 * game_make_move_interface::cancelled(), this reads the clock.
+		 */
+		bool cancelled() const {
+			return move_deadline != clock_type::time_point::max() && move_deadline <= clock_type::now();
+		}
+
+		/**
+		 * Plays the current player's state on a tile.
+		 * \throw rule_violation_exception in case the move is illegal.
+		 * \throw time_limit_exception in case the deadline has passed.
+		 */
+		void make_move(field::size_type index) {
+			make_move(index, current.current_player());
+		}
+
+		/**
+		 * Plays a state on a tile; only the current player's state is
+		 * allowed unless the rules offer a choice.
+		 * \throw rule_violation_exception in case the move is illegal.
+		 * \throw time_limit_exception in case the deadline has passed.
+		 */
+		void make_move(field::size_type index, field::tile state) {
+			if (moved) {
+				throw rule_violation_exception("You have already made your move.");
+			}
+			if (cancelled()) {
+				throw time_limit_exception("You have run out of time.");
+			}
+			if (current.size() <= index) {
+				throw rule_violation_exception("The chosen tile is invalid.");
+			}
+			if (current[index] != field::tile::empty) {
+				throw rule_violation_exception("The chosen tile is already occupied.");
+			}
+			if (state == field::tile::empty || (1 == rules_type::choices && state != current.current_player())) {
+				throw rule_violation_exception("The chosen state is not allowed.");
+			}
+			current.make_move(index, state);
+			moved = true;
+		}
+
+		/**
+		 * Returns whether make_move() has succeeded.
+		 */
+		bool has_moved() const noexcept { return moved; }
+
+	private:
+		field_position &current;
+		clock_type::time_point move_deadline;
+		bool moved;
+	};
+
+	typedef basic_move_interface<rules::standard> move_interface;
+
+	/**
+	 * Start a game with two players, see tictactoe::game().
+	 * \tparam rules_type The rules of the game, see rules.hpp.
+	 * \param settings The settings for this match; the order must not exceed
+	 *        field_position::max_order.
+	 * \return The state of the winning player or field::tile::empty in case
+	 *         of a draw.
+	 * \note Players derived from tictactoe::player are left to
+	 *       tictactoe::game(), even if found through argument dependent
+	 *       lookup.
+	 */
+	template<typename rules_type = rules::standard, typename player1_type, typename player2_type>
+	typename std::enable_if<
+		!std::is_base_of<player, player1_type>::value && !std::is_base_of<player, player2_type>::value,
+		field::tile
+	>::type game(player1_type &player1, player2_type &player2, const game_settings &settings = game_settings(), game_outcome *outcome = nullptr) {
+		typedef move_interface::clock_type clock_type;
+		field_position position(settings.order, settings.win_length);
+
+		const bool timed = settings.move_time.count() || settings.game_time.count();
+		clock_type::duration time_left[2] = { settings.game_time, settings.game_time };
+
+		while(position.game_status() == field_position::status::ongoing) {
+			const field::tile current_player = position.current_player();
+			const unsigned side = (current_player == field::tile::player2);
+
+			clock_type::time_point start, deadline = clock_type::time_point::max();
+			if (timed) {
+				start = clock_type::now();
+				if (settings.move_time.count()) {
+					deadline = start + settings.move_time;
+				}
+				if (settings.game_time.count()) {
+					deadline = std::min(deadline, start + time_left[side]);
+				}
+			}
+
+			basic_move_interface<rules_type> interface(position, deadline);
+			bool violated = false;
+			game_outcome violation = game_outcome::rule_violation;
+			try {
+				if (side) {
+					player2.make_move(interface);
+				}
+				else {
+					player1.make_move(interface);
+				}
+				violated = !interface.has_moved();
+				if (violated && interface.cancelled()) {
+					violation = game_outcome::timeout;
+				}
+			}
+			catch(time_limit_exception &) {
+				violated = true;
+				violation = game_outcome::timeout;
+			}
+			catch(rule_violation_exception &) {
+				violated = true;
+			}
+			if (violated) {
+				if (outcome) {
+					*outcome = violation;
+				}
+				return side ? field::tile::player1 : field::tile::player2;
+			}
+
+			if (timed) {
+				time_left[side] -= clock_type::now() - start;
+			}
+		}
+
+		// the player that made the last move is the opponent now
+		const field::tile winner = rules::winner<rules_type>(position.opponent_player(), position.game_status());
+		if (outcome) {
+			*outcome = (winner == field::tile::empty)
+				? game_outcome::draw
+				: game_outcome::won;
+		}
+		return winner;
+	}
+
+	/**
+	 * Plays a uniformly random empty tile, with a uniformly random state if
+	 * the rules offer a choice.
+	 */
+	struct random_player {
+		explicit random_player(std::uint64_t seed)
+		: gen(seed) {}
+
+		std::string name() const { return "random_player"; }
+
+		template<typename interface_type>
+		void make_move(interface_type &game) {
+			typedef typename interface_type::rules rules_type;
+			const field_position &position = game.position();
+			field::size_type skip = std::uniform_int_distribution<field::size_type>(0, position.empty_tiles() - 1)(gen);
+			for(field::size_type index = 0; ; ++index) {
+				if (position[index] == field::tile::empty && 0 == skip--) {
+					const unsigned choice = (1 < rules_type::choices)
+						? std::uniform_int_distribution<unsigned>(0, rules_type::choices - 1)(gen)
+						: 0;
+					game.make_move(index, rules_type::symbol(game.current_player(), choice));
+					return;
+				}
+			}
+		}
+
+	private:
+		std::mt19937_64 gen;
+	};
+
+	/**
+	 * Plays the best move found by a single threaded search, without any
+	 * output.
+	 */
+	template<typename rules_type>
+	struct basic_search_player {
+		/**
+		 * Create a player.
+		 * \param max_depth The maximum search depth; the search also stops at
+		 *        the move's deadline once the first iteration is completed.
+		 * \param table_size_log2 See transposition_table.
+		 */
+		explicit basic_search_player(unsigned max_depth = 0xff, unsigned table_size_log2 = 16);
+
+		std::string name() const { return "search_player"; }
+
+		void make_move(basic_move_interface<rules_type> &game) {
+			search_limits limits;
+			limits.max_depth = max_depth;
+			limits.deadline = game.deadline();
+			const field::size_type move = engine.search(game.position(), limits).move;
+			game.make_move(rules::move_index<rules_type>(move), rules::move_symbol<rules_type>(move, game.current_player()));
+		}
+
+	private:
+		unsigned max_depth;
+		transposition_table table;
+		basic_searcher<rules_type> engine;
+	};
+
+	typedef basic_search_player<rules::standard> search_player;
+
+	/**
+	 * Lets a simulation player take part in tictactoe::game(), e.g. in the
+	 * interactive binary. The position is copied into a field_position once
+	 * per move.
+	 */
+	template<typename wrapped_type>
+	struct dynamic_player : player {
+		dynamic_player(wrapped_type &wrapped, std::string name)
+		: wrapped(wrapped)
+		, player_name(name) {}
+
+		std::string name() const override {
+			return player_name;
+		}
+
+		void make_move(game_make_move_interface game) override {
+			field_position position(game.field(), game.current_player());
+			move_interface interface(position, game.deadline());
+			wrapped.make_move(interface);
+			if (interface.has_moved()) {
+				game.make_move(position.last_move());
+			}
+		}
+
+	private:
+		wrapped_type &wrapped;
+		std::string player_name;
+	};
+}
+}
+
+#endif // TICTACTOE_SIMULATION_HPP_INCLUDED
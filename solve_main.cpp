@@ -0,0 +1,190 @@
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "field_position.hpp"
+#include "proof_solver.hpp"
+
+using namespace tictactoe;
+
+namespace {
+	const char *describe(proof_result result, field::tile current_player) {
+		const bool player1 = current_player == field::tile::player1;
+		switch(result) {
+		case proof_result::win:
+			return player1 ? "player 1 wins" : "player 2 wins";
+		case proof_result::loss:
+			return player1 ? "player 2 wins" : "player 1 wins";
+		case proof_result::draw:
+			return "draw";
+		case proof_result::unknown:
+			break;
+		}
+		return "unknown (node limit reached)";
+	}
+
+	void print_statistics(const proof_statistics &stats) {
+		std::cout <<
+			"Nodes:          " << stats.nodes << "\n"
+			"Time:           " << std::fixed << std::setprecision(3) << stats.elapsed.count() << "s\n"
+			"Nodes/s:        " << static_cast<std::uint64_t>(stats.nodes_per_second()) << "\n"
+			"Table memory:   " << (stats.table_memory >> 20) << " MiB, " << stats.table_entries << " entries used\n"
+			"Peak memory:    ";
+		if (stats.peak_memory) {
+			std::cout << (stats.peak_memory >> 20) << " MiB\n";
+		}
+		else {
+			std::cout << "unavailable\n";
+		}
+	}
+
+	/**
+	 * Checks all proof trees of a file and prints their claims.
+	 */
+	int check_proofs(const std::string &path) {
+		std::ifstream file(path);
+		if (!file) {
+			std::cerr << "Error: Cannot open " << path << ".\n";
+			return 1;
+		}
+
+		std::vector<proof_claim> claims;
+		try {
+			while(file >> std::ws && !file.eof()) {
+				claims.push_back(check_proof(file));
+				const proof_claim &claim = claims.back();
+				std::cout <<
+					"Verified: player " << ((claim.attacker == field::tile::player1) ? 1 : 2) <<
+					(claim.attacker_wins ? " wins" : " cannot win") <<
+					" (" << claim.nodes << " nodes)\n";
+			}
+		}
+		catch(std::exception &e) {
+			std::cerr << "Error: " << e.what() << '\n';
+			return 1;
+		}
+
+		// a draw takes two proofs that neither player can win
+		if (
+			2 == claims.size() && !claims[0].attacker_wins && !claims[1].attacker_wins &&
+			claims[0].attacker != claims[1].attacker && claims[0].current_player == claims[1].current_player &&
+			symmetry::key(claims[0].position, claims[0].current_player) == symmetry::key(claims[1].position, claims[1].current_player)
+		) {
+			std::cout << "Result:         draw\n";
+		}
+		return 0;
+	}
+}
+
+int main(int argc, const char * const argv[]) {
+	field::size_type order = 3, win_length = 0;
+	std::size_t memory_mib = 256;
+	std::uint64_t max_nodes = 0;
+	std::vector<field::size_type> moves;
+	std::string proof_path, check_path;
+	bool valid_options = true;
+
+	for(int arg = 1; arg < argc; arg += 2) {
+		const std::string option(argv[arg]);
+		const std::string text((arg + 1 < argc) ? argv[arg + 1] : "");
+		std::stringstream value(text);
+		unsigned long long number = 0;
+
+		if ("--proof" == option && !text.empty()) {
+			proof_path = text;
+		}
+		else if ("--check" == option && !text.empty()) {
+			check_path = text;
+		}
+		else if ("--moves" == option) {
+			for(std::string move; std::getline(value, move, ',') && valid_options; ) {
+				std::stringstream move_value(move);
+				valid_options = static_cast<bool>(move_value >> number);
+				moves.push_back(number);
+			}
+		}
+		else if (!(value >> number)) {
+			valid_options = false;
+		}
+		else if ("--order" == option && 0 < number && number <= field_position::max_order) {
+			order = number;
+		}
+		else if ("--win-length" == option) {
+			win_length = number;
+		}
+		else if ("--memory" == option && 0 < number) {
+			memory_mib = number;
+		}
+		else if ("--max-nodes" == option) {
+			max_nodes = number;
+		}
+		else {
+			valid_options = false;
+		}
+	}
+
+	field_position position(order, (win_length <= order) ? win_length : order);
+	for(const field::size_type move : moves) {
+		valid_options = valid_options && position.is_legal(move);
+		if (valid_options) {
+			position.make_move(move);
+		}
+	}
+	valid_options = valid_options && win_length <= order && position.game_status() == field_position::status::ongoing;
+
+	if (!valid_options) {
+		std::cerr <<
+			"Usage:\n"
+			"\t" << argv[0] << " [<options>]\n"
+			"\n"
+			"Solves a position with a proof-number search and prints its value.\n"
+			"\n"
+			"--order <n>\n"
+			"\tSolve a field of n by n tiles (default: 3).\n"
+			"--win-length <k>\n"
+			"\tThe number of tiles in a row needed to win (default: a full row).\n"
+			"--moves <i>,<j>,...\n"
+			"\tThe moves played before the position, as flat tile indices.\n"
+			"--memory <MiB>\n"
+			"\tThe size of the transposition table (default: 256).\n"
+			"--max-nodes <n>\n"
+			"\tGive up after n nodes per proof (default: no limit).\n"
+			"--proof <file>\n"
+			"\tWrite the proof trees of the result to a file.\n"
+			"--check <file>\n"
+			"\tOnly check the proof trees of a file instead of solving.\n";
+		return 1;
+	}
+
+	if (!check_path.empty()) {
+		return check_proofs(check_path);
+	}
+
+	proof_solver solver(memory_mib << 20);
+	const proof_result result = solver.solve(position, max_nodes);
+	std::cout << "Result:         " << describe(result, position.current_player()) << '\n';
+	print_statistics(solver.statistics());
+
+	if (!proof_path.empty() && result != proof_result::unknown) {
+		std::ofstream file(proof_path);
+		const field::tile
+			current_player = position.current_player(),
+			opponent_player = position.opponent_player();
+		if (result != proof_result::loss) {
+			solver.write_proof(file, position, current_player);
+		}
+		if (result != proof_result::win) {
+			solver.write_proof(file, position, opponent_player);
+		}
+		if (!file) {
+			std::cerr << "Error: Cannot write " << proof_path << ".\n";
+			return 1;
+		}
+		std::cout << "Proof written to " << proof_path << ".\n";
+	}
+	return 0;
+}
@@ -0,0 +1,496 @@
+#include "spectator.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <poll.h>
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
+
+namespace {
+	constexpr unsigned max_order = 16; // moves have to fit the wire format
+
+	enum frame_kind : unsigned {
+		keyframe_frame = 1,
+		move_frame = 2,
+		game_over_frame = 3
+	};
+
+	// returns false if nothing could be read at all, throws if only parts
+	// of the value could be read
+	bool read_bytes(std::istream &is, std::uint64_t &value, unsigned bytes) {
+		unsigned char buffer[8];
+		is.read(reinterpret_cast<char *>(buffer), bytes);
+		if (0 == is.gcount()) {
+			return false;
+		}
+		if (static_cast<unsigned>(is.gcount()) != bytes) {
+			throw std::runtime_error("Truncated input.");
+		}
+		value = 0;
+		for(unsigned index = 0; index < bytes; ++index) {
+			value |= static_cast<std::uint64_t>(buffer[index]) << (8 * index);
+		}
+		return true;
+	}
+
+	void read_required(std::istream &is, std::uint64_t &value, unsigned bytes) {
+		if (!read_bytes(is, value, bytes)) {
+			throw std::runtime_error("Truncated input.");
+		}
+	}
+
+#ifndef _WIN32
+	constexpr int max_iovecs = 64;
+#ifdef MSG_NOSIGNAL
+	constexpr int no_sigpipe = MSG_NOSIGNAL;
+#else
+	constexpr int no_sigpipe = 0; // SO_NOSIGPIPE is set on the sockets instead
+#endif
+
+	// makes a descriptor non-blocking and closes it on exec; sockets don't
+	// raise SIGPIPE when written to after the peer has closed them
+	bool prepare_descriptor(int descriptor) {
+#ifdef SO_NOSIGPIPE
+		const int enabled = 1;
+		setsockopt(descriptor, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+		const int flags = fcntl(descriptor, F_GETFL);
+		return
+			0 <= flags && 0 == fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) &&
+			0 == fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+	}
+
+	void append_bytes(std::vector<std::uint8_t> &buffer, std::uint64_t value, unsigned bytes) {
+		for(unsigned index = 0; index < bytes; ++index) {
+			buffer.push_back(static_cast<std::uint8_t>((value >> (8 * index)) & 0xff));
+		}
+	}
+
+	// sequence numbers wrap around
+	bool before(std::uint32_t sequence, std::uint32_t other) {
+		return static_cast<std::int32_t>(sequence - other) < 0;
+	}
+
+	// the header of a frame; the sequence number is filled in on publishing
+	std::vector<std::uint8_t> frame_header(frame_kind kind) {
+		std::vector<std::uint8_t> encoded;
+		encoded.push_back(kind);
+		append_bytes(encoded, 0, 4);
+		return encoded;
+	}
+#endif
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// wire format
+//
+
+tictactoe::spectator_view::spectator_view()
+: sequence(0)
+, synchronized(false)
+, game_over(false)
+, winner(field::tile::empty)
+, skipped_frames(0) {}
+
+bool tictactoe::read_spectator_frame(std::istream &is, spectator_view &view) {
+	std::uint64_t kind, sequence;
+	if (!read_bytes(is, kind, 1)) {
+		return false;
+	}
+	read_required(is, sequence, 4);
+
+	const bool missed = !view.synchronized || sequence != static_cast<std::uint32_t>(view.sequence + 1);
+	if (missed && view.synchronized) {
+		view.skipped_frames += static_cast<std::uint32_t>(sequence - view.sequence - 1);
+	}
+	if (missed && keyframe_frame != kind) {
+		throw std::runtime_error("Frames are missing before a move.");
+	}
+
+	if (keyframe_frame == kind) {
+		std::uint64_t order, win_length;
+		read_required(is, order, 1);
+		read_required(is, win_length, 1);
+		if (0 == order || max_order < order || order < win_length) {
+			throw std::runtime_error("Invalid keyframe.");
+		}
+
+		field position(order, win_length);
+		for(field::size_type first_tile = 0; first_tile < position.size(); first_tile += 4) {
+			std::uint64_t packed;
+			read_required(is, packed, 1);
+			for(field::size_type index = first_tile; index < std::min<field::size_type>(first_tile + 4, position.size()); ++index, packed >>= 2) {
+				if (3 == (packed & 3)) {
+					throw std::runtime_error("Invalid keyframe.");
+				}
+				position[index] = static_cast<field::tile>(packed & 3);
+			}
+		}
+		view.position = position;
+		view.synchronized = true;
+		view.game_over = false;
+		view.winner = field::tile::empty;
+	}
+	else if (move_frame == kind) {
+		std::uint64_t index, player;
+		read_required(is, index, 2);
+		read_required(is, player, 1);
+		if (
+			view.game_over || view.position.size() <= index ||
+			view.position[index] != field::tile::empty || (1 != player && 2 != player)
+		) {
+			throw std::runtime_error("Invalid move.");
+		}
+		view.position[index] = static_cast<field::tile>(player);
+	}
+	else if (game_over_frame == kind) {
+		std::uint64_t winner;
+		read_required(is, winner, 1);
+		if (2 < winner) {
+			throw std::runtime_error("Invalid winner.");
+		}
+		view.game_over = true;
+		view.winner = static_cast<field::tile>(winner);
+	}
+	else {
+		throw std::runtime_error("Unknown frame.");
+	}
+
+	view.sequence = static_cast<std::uint32_t>(sequence);
+	return true;
+}
+
+
+
+#ifndef _WIN32
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::spectator_broadcaster
+//
+
+tictactoe::spectator_broadcaster::settings::settings()
+: keyframe_interval(8)
+, history_size(1024) {}
+
+tictactoe::spectator_broadcaster::spectator_broadcaster(const settings &broadcast_settings)
+: config(broadcast_settings)
+, moves_since_keyframe(0)
+, history_start(0)
+, latest_keyframe(0)
+, next_sequence(0)
+, sent_sequence(0)
+, listener(-1)
+, statistic()
+, stopping(false) {
+	if (pipe(wakeup_pipe)) {
+		throw std::runtime_error(std::string("Cannot create a pipe: ") + std::strerror(errno));
+	}
+	prepare_descriptor(wakeup_pipe[0]);
+	prepare_descriptor(wakeup_pipe[1]);
+	thread = std::thread(&spectator_broadcaster::send_frames, this);
+}
+
+tictactoe::spectator_broadcaster::~spectator_broadcaster() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake();
+	thread.join();
+
+	for(const subscriber &spectator : subscribers) {
+		close(spectator.socket);
+	}
+	for(const subscriber &spectator : incoming) {
+		close(spectator.socket);
+	}
+	if (0 <= listener) {
+		close(listener);
+	}
+	for(const int retired : retired_listeners) {
+		close(retired);
+	}
+	close(wakeup_pipe[0]);
+	close(wakeup_pipe[1]);
+}
+
+void tictactoe::spectator_broadcaster::listen(const std::string &path) {
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (sizeof(address.sun_path) <= path.size()) {
+		throw std::runtime_error("The socket path " + path + " is too long.");
+	}
+	std::strcpy(address.sun_path, path.c_str());
+
+	const int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(path.c_str());
+	if (
+		socket < 0 || !prepare_descriptor(socket) ||
+		bind(socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) ||
+		::listen(socket, SOMAXCONN)
+	) {
+		const std::string error = std::strerror(errno);
+		if (0 <= socket) {
+			close(socket);
+		}
+		throw std::runtime_error("Cannot listen on " + path + ": " + error);
+	}
+
+	{
+		// the sending thread may still poll the old socket, so it closes it
+		std::lock_guard<std::mutex> lock(mutex);
+		if (0 <= listener) {
+			retired_listeners.push_back(listener);
+		}
+		listener = socket;
+	}
+	wake();
+}
+
+void tictactoe::spectator_broadcaster::subscribe(int socket) {
+	prepare_descriptor(socket);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const subscriber spectator = { socket, latest_keyframe, nullptr, 0 };
+		incoming.push_back(spectator);
+	}
+	wake();
+}
+
+void tictactoe::spectator_broadcaster::start_game(const field &position) {
+	publish_keyframe(position);
+}
+
+void tictactoe::spectator_broadcaster::move(const field &position, field::size_type index) {
+	std::vector<std::uint8_t> encoded = frame_header(move_frame);
+	append_bytes(encoded, index, 2);
+	append_bytes(encoded, static_cast<unsigned>(position[index]), 1);
+	publish(std::move(encoded), false);
+
+	if (config.keyframe_interval && config.keyframe_interval <= ++moves_since_keyframe) {
+		publish_keyframe(position);
+	}
+}
+
+void tictactoe::spectator_broadcaster::end_game(field::tile winner) {
+	std::vector<std::uint8_t> encoded = frame_header(game_over_frame);
+	append_bytes(encoded, static_cast<unsigned>(winner), 1);
+	publish(std::move(encoded), false);
+}
+
+bool tictactoe::spectator_broadcaster::flush(std::chrono::milliseconds timeout) {
+	std::unique_lock<std::mutex> lock(mutex);
+	return sent.wait_for(lock, timeout, [this]() {
+		return sent_sequence == next_sequence && incoming.empty();
+	});
+}
+
+tictactoe::spectator_broadcaster::statistics tictactoe::spectator_broadcaster::stats() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return statistic;
+}
+
+void tictactoe::spectator_broadcaster::publish(std::vector<std::uint8_t> &&encoded, bool is_keyframe) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for(unsigned index = 0; index < 4; ++index) {
+			encoded[1 + index] = static_cast<std::uint8_t>((next_sequence >> (8 * index)) & 0xff);
+		}
+		if (is_keyframe) {
+			latest_keyframe = next_sequence;
+		}
+		history.push_back(std::make_shared<const std::vector<std::uint8_t>>(std::move(encoded)));
+		++next_sequence;
+		++statistic.frames;
+
+		// subscribers behind the history skip forward to the latest
+		// keyframe, so that has to stay
+		while(config.history_size < history.size() && before(history_start, latest_keyframe)) {
+			history.pop_front();
+			++history_start;
+		}
+	}
+	wake();
+}
+
+void tictactoe::spectator_broadcaster::publish_keyframe(const field &position) {
+	std::vector<std::uint8_t> encoded = frame_header(keyframe_frame);
+	append_bytes(encoded, position.order(), 1);
+	append_bytes(encoded, position.win_length(), 1);
+	for(field::size_type first_tile = 0; first_tile < position.size(); first_tile += 4) {
+		unsigned packed = 0;
+		for(field::size_type index = std::min<field::size_type>(first_tile + 4, position.size()); first_tile < index--; ) {
+			packed = (packed << 2) | static_cast<unsigned>(position[index]);
+		}
+		append_bytes(encoded, packed, 1);
+	}
+	moves_since_keyframe = 0;
+	publish(std::move(encoded), true);
+}
+
+void tictactoe::spectator_broadcaster::wake() {
+	// a full pipe already wakes the thread
+	const char signal = 0;
+	const ssize_t written = write(wakeup_pipe[1], &signal, 1);
+	static_cast<void>(written);
+}
+
+void tictactoe::spectator_broadcaster::send_frames() {
+	std::vector<frame> frames;
+	std::vector<pollfd> polled;
+	for(;;) {
+		statistics counters = statistics();
+		std::uint32_t first, end;
+		int listening;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (stopping) {
+				return;
+			}
+			for(const int retired : retired_listeners) {
+				close(retired);
+			}
+			retired_listeners.clear();
+			subscribers.insert(subscribers.end(), incoming.begin(), incoming.end());
+			statistic.subscribers += incoming.size();
+			incoming.clear();
+
+			end = next_sequence;
+			first = end;
+			for(subscriber &spectator : subscribers) {
+				if (before(spectator.next, history_start)) {
+					counters.skipped_frames += latest_keyframe - spectator.next;
+					spectator.next = latest_keyframe;
+				}
+				first = before(spectator.next, first) ? spectator.next : first;
+			}
+			// copying the history only copies references to the frames
+			frames.assign(history.begin() + (first - history_start), history.end());
+			listening = listener;
+		}
+
+		bool all_sent = true;
+		for(std::size_t index = 0; index < subscribers.size(); ) {
+			subscriber &spectator = subscribers[index];
+			if (!send(spectator, first, frames, counters)) {
+				close(spectator.socket);
+				spectator = subscribers.back();
+				subscribers.pop_back();
+				++counters.dropped_subscribers;
+				continue;
+			}
+			all_sent = all_sent && !spectator.partial && spectator.next == end;
+			++index;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			statistic.bytes_sent += counters.bytes_sent;
+			statistic.writes += counters.writes;
+			statistic.skipped_frames += counters.skipped_frames;
+			statistic.dropped_subscribers += counters.dropped_subscribers;
+			if (all_sent) {
+				sent_sequence = end;
+				sent.notify_all();
+			}
+		}
+
+		// sleep until there is something new or a full socket has room again
+		polled.clear();
+		polled.push_back(pollfd { wakeup_pipe[0], POLLIN, 0 });
+		if (0 <= listening) {
+			polled.push_back(pollfd { listening, POLLIN, 0 });
+		}
+		for(const subscriber &spectator : subscribers) {
+			if (spectator.partial || spectator.next != end) {
+				polled.push_back(pollfd { spectator.socket, POLLOUT, 0 });
+			}
+		}
+		while(poll(polled.data(), polled.size(), -1) < 0 && EINTR == errno) {}
+
+		if (polled[0].revents) {
+			char signals[64];
+			while(0 < read(wakeup_pipe[0], signals, sizeof(signals))) {}
+		}
+		if (0 <= listening && polled[1].revents) {
+			for(int socket; 0 <= (socket = accept(listening, nullptr, nullptr)); ) {
+				prepare_descriptor(socket);
+				std::lock_guard<std::mutex> lock(mutex);
+				const subscriber spectator = { socket, latest_keyframe, nullptr, 0 };
+				incoming.push_back(spectator);
+			}
+		}
+	}
+}
+
+bool tictactoe::spectator_broadcaster::send(subscriber &spectator, std::uint32_t first, const std::vector<frame> &frames, statistics &counters) {
+	const std::uint32_t end = first + static_cast<std::uint32_t>(frames.size());
+	for(;;) {
+		iovec vectors[max_iovecs];
+		int num_vectors = 0;
+		std::size_t total = 0;
+		if (spectator.partial) {
+			vectors[num_vectors].iov_base = const_cast<std::uint8_t *>(spectator.partial->data() + spectator.offset);
+			vectors[num_vectors].iov_len = spectator.partial->size() - spectator.offset;
+			total += vectors[num_vectors++].iov_len;
+		}
+		for(std::uint32_t sequence = spectator.next; num_vectors < max_iovecs && before(sequence, end); ++sequence) {
+			const frame &next_frame = frames[sequence - first];
+			vectors[num_vectors].iov_base = const_cast<std::uint8_t *>(next_frame->data());
+			vectors[num_vectors].iov_len = next_frame->size();
+			total += vectors[num_vectors++].iov_len;
+		}
+		if (0 == num_vectors) {
+			return true;
+		}
+
+		msghdr message;
+		std::memset(&message, 0, sizeof(message));
+		message.msg_iov = vectors;
+		message.msg_iovlen = num_vectors;
+		const ssize_t written = sendmsg(spectator.socket, &message, MSG_DONTWAIT | no_sigpipe);
+		++counters.writes;
+		if (written < 0) {
+			if (EINTR == errno) {
+				continue;
+			}
+			return EAGAIN == errno || EWOULDBLOCK == errno;
+		}
+		counters.bytes_sent += written;
+
+		std::size_t left = written;
+		if (spectator.partial) {
+			const std::size_t rest = spectator.partial->size() - spectator.offset;
+			if (left < rest) {
+				spectator.offset += left;
+				return true;
+			}
+			left -= rest;
+			spectator.partial.reset();
+			spectator.offset = 0;
+		}
+		while(0 < left) {
+			const frame &next_frame = frames[spectator.next++ - first];
+			if (left < next_frame->size()) {
+				spectator.partial = next_frame;
+				spectator.offset = left;
+				break;
+			}
+			left -= next_frame->size();
+		}
+
+		if (static_cast<std::size_t>(written) < total) {
+			return true; // the socket is full
+		}
+	}
+}
+#endif
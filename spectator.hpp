@@ -0,0 +1,241 @@
+#ifndef TICTACTOE_SPECTATOR_HPP_INCLUDED
+#define TICTACTOE_SPECTATOR_HPP_INCLUDED
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "field.hpp"
+#include "game_observer.hpp"
+
+namespace tictactoe {
+
+/**
+ * What a spectator knows about the game it watches, built from the frames a
+ * spectator_broadcaster sends.
+ *
+ * Wire format of a frame (little endian):
+ *   uint8 kind, uint32 sequence, followed by
+ *   - kind 1, keyframe: uint8 order, uint8 win_length and
+ *     ceil(order * order / 4) bytes of tiles, packed like in an
+ *     evaluation_query;
+ *   - kind 2, move: uint16 index, uint8 player (1 or 2);
+ *   - kind 3, game over: uint8 winner (0 for a draw, 1 or 2).
+ * Frames are numbered consecutively. A spectator that fell behind misses
+ * some of them and continues with the next keyframe.
+ */
+struct spectator_view {
+	/**
+	 * Create a view that has not seen a keyframe yet.
+	 */
+	spectator_view();
+
+	field position;
+	/**
+	 * The sequence number of the last frame read.
+	 */
+	std::uint32_t sequence;
+	/**
+	 * Whether a keyframe has been read, i.e. whether position is valid.
+	 */
+	bool synchronized;
+	bool game_over;
+	/**
+	 * The winner once game_over is set; empty for a draw.
+	 */
+	field::tile winner;
+	/**
+	 * The number of frames missed in total.
+	 */
+	std::uint64_t skipped_frames;
+};
+
+/**
+ * Reads a frame in wire format and applies it to a view.
+ * \return false on end of input.
+ * \throw std::runtime_error on malformed or truncated input, or if frames
+ *        were missed and the next frame is not a keyframe.
+ */
+bool read_spectator_frame(std::istream &is, spectator_view &view);
+
+#ifndef _WIN32
+/**
+ * Streams the moves of games to any number of spectators connected through
+ * local sockets. Not available on Windows.
+ *
+ * Every move is encoded once into a reference counted frame, followed by a
+ * keyframe of the full field every few moves. A separate thread sends the
+ * frames to all subscribers with non-blocking scatter/gather writes, each
+ * subscriber referencing the shared frames instead of a copy. Only the most
+ * recent frames are kept: a subscriber that falls further behind skips
+ * forward to the latest keyframe, so neither slow spectators nor a large
+ * number of them ever block the game.
+ */
+struct spectator_broadcaster : game_observer {
+	typedef std::shared_ptr<const std::vector<std::uint8_t>> frame;
+
+	struct settings {
+		/**
+		 * Create the default settings: a keyframe after every 8 moves and
+		 * a history of 1024 frames.
+		 */
+		settings();
+
+		/**
+		 * The number of moves between keyframes; 0 only sends one at the
+		 * start of each game.
+		 */
+		unsigned keyframe_interval;
+
+		/**
+		 * The number of frames kept for subscribers that are behind; the
+		 * frames since the latest keyframe are kept in any case.
+		 */
+		std::size_t history_size;
+	};
+
+	struct statistics {
+		std::uint64_t frames;
+		std::uint64_t bytes_sent;
+		/**
+		 * The number of scatter/gather writes, one per subscriber and round
+		 * in which it had frames to send.
+		 */
+		std::uint64_t writes;
+		std::uint64_t skipped_frames;
+		std::uint64_t subscribers;
+		/**
+		 * The number of subscribers that have been closed because their
+		 * socket failed or was closed by the spectator.
+		 */
+		std::uint64_t dropped_subscribers;
+	};
+
+	/**
+	 * Create a broadcaster and start its sending thread.
+	 */
+	explicit spectator_broadcaster(const settings &broadcast_settings = settings());
+
+	/**
+	 * Stops the sending thread and closes all sockets; frames that have not
+	 * been sent yet are discarded.
+	 */
+	~spectator_broadcaster();
+
+	spectator_broadcaster(const spectator_broadcaster &) = delete;
+	spectator_broadcaster &operator=(const spectator_broadcaster &) = delete;
+
+	/**
+	 * Accepts spectators on a Unix domain socket, replacing any file at the
+	 * given path.
+	 * \throw std::runtime_error if the socket cannot be created.
+	 */
+	void listen(const std::string &path);
+
+	/**
+	 * Adds a spectator. It starts with the latest keyframe.
+	 * \param socket A connected stream socket; the broadcaster makes it
+	 *        non-blocking and closes it when done.
+	 */
+	void subscribe(int socket);
+
+	/**
+	 * Publishes the start of a game with a keyframe.
+	 */
+	void start_game(const field &position) override;
+
+	/**
+	 * Publishes a move.
+	 * \param position The field after the move.
+	 * \param index The flat index of the tile played.
+	 */
+	void move(const field &position, field::size_type index) override;
+
+	/**
+	 * Publishes the end of a game.
+	 * \param winner The winning player or empty for a draw.
+	 */
+	void end_game(field::tile winner) override;
+
+	/**
+	 * Waits until all frames published so far have been sent to every
+	 * subscriber.
+	 * \return false if that did not happen within the timeout.
+	 */
+	bool flush(std::chrono::milliseconds timeout);
+
+	/**
+	 * Returns the statistics of all games published so far.
+	 */
+	statistics stats() const;
+
+private:
+	struct subscriber {
+		int socket;
+		/**
+		 * The sequence number of the next frame to send after the partial
+		 * one.
+		 */
+		std::uint32_t next;
+		/**
+		 * The frame being sent, kept alive even once it has left the
+		 * history, and the number of its bytes sent.
+		 */
+		frame partial;
+		std::size_t offset;
+	};
+
+	void publish(std::vector<std::uint8_t> &&encoded, bool keyframe);
+	void publish_keyframe(const field &position);
+	void wake();
+	void send_frames();
+	bool send(subscriber &spectator, std::uint32_t first, const std::vector<frame> &frames, statistics &counters);
+
+	settings config;
+	unsigned moves_since_keyframe;
+
+	mutable std::mutex mutex;
+	std::condition_variable sent;
+	/**
+	 * The most recent frames, the first one numbered history_start.
+	 */
+	std::deque<frame> history;
+	std::uint32_t history_start;
+	std::uint32_t latest_keyframe;
+	std::uint32_t next_sequence;
+	/**
+	 * All frames before this one have been sent to all subscribers.
+	 */
+	std::uint32_t sent_sequence;
+	/**
+	 * Subscribers not yet picked up by the sending thread.
+	 */
+	std::vector<subscriber> incoming;
+	int listener;
+	/**
+	 * Listening sockets replaced by listen(), closed by the sending thread
+	 * once it no longer polls them.
+	 */
+	std::vector<int> retired_listeners;
+	statistics statistic;
+	bool stopping;
+
+	/**
+	 * Written to by publishers to wake the sending thread from poll().
+	 */
+	int wakeup_pipe[2];
+	std::vector<subscriber> subscribers;
+	std::thread thread;
+};
+#endif
+
+}
+
+#endif // TICTACTOE_SPECTATOR_HPP_INCLUDED
@@ -0,0 +1,75 @@
+#include "symmetry.hpp"
+
+#include <cassert>
+
+tictactoe::field::size_type tictactoe::symmetry::transform_index(field::size_type order, field::size_type index, unsigned symmetry) {
+	assert(symmetry < count);
+	const field::size_type max_coord = order - 1;
+	field::size_type
+		x = index % order,
+		y = index / order;
+
+	if (4 <= symmetry) {
+		                   // Transformation matrix:
+		x = max_coord - x; //   | -1 0 |
+		                   //   |  0 1 |
+	}
+	for(unsigned rotations = symmetry % 4; rotations--; ) {
+		const field::size_type old_x = x;
+		                   // Transformation matrix:
+		x = max_coord - y; //   | 0 -1 |
+		y = old_x;         //   | 1  0 |
+	}
+	return x + y * order;
+}
+
+unsigned tictactoe::symmetry::inverse(unsigned symmetry) {
+	assert(symmetry < count);
+	// mirrored symmetries are reflections and therefore their own inverse
+	return (4 <= symmetry)
+		? symmetry
+		: (4 - symmetry) % 4;
+}
+
+tictactoe::field tictactoe::symmetry::transform(const field &position, unsigned symmetry) {
+	field result(position.order(), position.win_length());
+	for(field::size_type index = 0; index < position.size(); ++index) {
+		result[transform_index(position.order(), index, symmetry)] = position[index];
+	}
+	return result;
+}
+
+std::string tictactoe::symmetry::key(const field &position, field::tile current_player) {
+	std::string result;
+	result.reserve(3 + position.size());
+	result += static_cast<char>(position.order());
+	result += static_cast<char>(position.win_length());
+	result += static_cast<char>(current_player);
+	for(field::size_type index = 0; index < position.size(); ++index) {
+		result += static_cast<char>(position[index]);
+	}
+	return result;
+}
+
+unsigned tictactoe::symmetry::canonical(const field &position, field::tile current_player, std::string *canonical_key) {
+	const field::size_type
+		order = position.order(),
+		header = 3;
+
+	std::string best = key(position, current_player), candidate = best;
+	unsigned best_symmetry = 0;
+	for(unsigned symmetry = 1; symmetry < count; ++symmetry) {
+		for(field::size_type index = 0; index < position.size(); ++index) {
+			candidate[header + transform_index(order, index, symmetry)] = static_cast<char>(position[index]);
+		}
+		if (candidate < best) {
+			best = candidate;
+			best_symmetry = symmetry;
+		}
+	}
+
+	if (canonical_key) {
+		*canonical_key = best;
+	}
+	return best_symmetry;
+}
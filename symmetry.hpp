@@ -0,0 +1,49 @@
+#ifndef TICTACTOE_SYMMETRY_HPP_INCLUDED
+#define TICTACTOE_SYMMETRY_HPP_INCLUDED
+
+#include <string>
+
+#include "field.hpp"
+
+namespace tictactoe {
+/**
+ * The eight symmetries of a square field, numbered 0 - 7: symmetry s mirrors
+ * the field horizontally if s >= 4 and then rotates it s % 4 times by 90
+ * degrees, using the same transformations as game_make_move_interface.
+ */
+namespace symmetry {
+	constexpr unsigned count = 8;
+
+	/**
+	 * Returns the index the tile with the given index is moved to.
+	 */
+	field::size_type transform_index(field::size_type order, field::size_type index, unsigned symmetry);
+
+	/**
+	 * Returns the symmetry that undoes the given symmetry.
+	 */
+	unsigned inverse(unsigned symmetry);
+
+	/**
+	 * Returns a transformed copy of a field.
+	 */
+	field transform(const field &position, unsigned symmetry);
+
+	/**
+	 * Returns a compact key identifying a position and the player to move,
+	 * including the field's geometry.
+	 */
+	std::string key(const field &position, field::tile current_player);
+
+	/**
+	 * Returns the symmetry that transforms a position into its canonical
+	 * form, i.e. the one of its eight transformations with the smallest
+	 * key().
+	 * \param canonical_key If not nullptr, receives the key of the canonical
+	 *        form.
+	 */
+	unsigned canonical(const field &position, field::tile current_player, std::string *canonical_key = nullptr);
+}
+}
+
+#endif // TICTACTOE_SYMMETRY_HPP_INCLUDED
@@ -1,75 +1,308 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
 
 #include "computer_player.hpp"
+#include "evaluation_service.hpp"
 #include "field.hpp"
+#include "field_position.hpp"
 #include "game.hpp"
+#include "game_analytics.hpp"
+#include "game_observer.hpp"
+#include "game_records.hpp"
+#include "parallel_searcher.hpp"
+#include "pattern_evaluator.hpp"
+#include "pattern_player.hpp"
 #include "player.hpp"
+#include "proof_solver.hpp"
+#include "rules.hpp"
+#include "searcher.hpp"
+#include "self_play.hpp"
+#include "sharding.hpp"
+#include "simulation.hpp"
+#include "spectator.hpp"
+#include "symmetry.hpp"
+#include "tracing.hpp"
+#include "transposition_table.hpp"
+#include "ultimate_computer_player.hpp"
+#include "ultimate_game.hpp"
+#include "ultimate_player.hpp"
 
 using namespace tictactoe;
 
-struct test_player : player {
+struct test_player : pattern_player {
 	/**
 	 * Creates a new CPU test player with a predefined test pattern.
 	 */
 	test_player(
 		const std::vector<field::size_type> pattern,
 		field::size_type seed
-	) {
-		std::stringstream namebuilder;
-		namebuilder << "test_player({";
-
-		moves.reserve(pattern.size());
-		for(auto move_pattern : pattern) {
-			const auto move = seed % move_pattern;
-			seed /= move_pattern;
+	)
+	: pattern_player(pattern, seed) {}
 
-			if (!moves.empty()) namebuilder << ", ";
-			namebuilder << move;
-			moves.emplace_back(move);
+	void make_move(game_make_move_interface game_interface) override {
+		try {
+			pattern_player::make_move(game_interface);
+		}
+		catch(std::exception &e) {
+			std::cerr << "FAILURE: Exception caught: " << e.what() << "\n";
+			exit(1);
+		}
+		catch(...) {
+			std::cerr << "FAILURE: Exception caught!\n";
+			exit(1);
 		}
-		next_move = moves.begin();
+	}
+};
 
-		namebuilder << "}) @ " << static_cast<const void *>(this);
-		playername = namebuilder.str();
+struct timed_player : player {
+	/**
+	 * Wraps another player and records the longest time it took for a move.
+	 */
+	timed_player(player &wrapped)
+	: wrapped(wrapped)
+	, longest_move(0) {}
+
+	std::string name() const override {
+		return wrapped.name();
 	}
 
+	void make_move(game_make_move_interface game_interface) override {
+		const auto start = std::chrono::steady_clock::now();
+		const auto deadline = game_interface.deadline();
+		wrapped.make_move(game_interface);
+		const auto end = std::chrono::steady_clock::now();
+
+		longest_move = std::max<std::chrono::steady_clock::duration>(longest_move, end - start);
+		if (deadline < end) {
+			std::cerr << "FAILURE: Move deadline exceeded!\n";
+			exit(1);
+		}
+	}
+
+	player &wrapped;
+	std::chrono::steady_clock::duration longest_move;
+};
+
+struct slow_player : player {
+	/**
+	 * Creates a player that thinks for a fixed time, polling for
+	 * cancellation, and then plays the first empty tile. A player without a
+	 * delay thinks until it is cancelled and never moves.
+	 */
+	slow_player(std::chrono::milliseconds delay)
+	: delay(delay)
+	, cancelled_moves(0) {}
+
 	std::string name() const override {
-		return playername;
+		return "slow_player(" + std::to_string(delay.count()) + "ms)";
 	}
 
 	void make_move(game_make_move_interface game_interface) override {
-		try {
-			field::size_type index = 0;
-			while(index < game_interface.field().size()) {
-				if (game_interface[index] == field::tile::empty) {
-					if (0 == *next_move) {
-						++next_move;
-						game_interface.make_move(index);
-						return;
-					}
-					--*next_move;
-				}
-				++index;
+		const auto end = std::chrono::steady_clock::now() + delay;
+		while(!delay.count() || std::chrono::steady_clock::now() < end) {
+			if (game_interface.cancelled()) {
+				++cancelled_moves;
+				return;
 			}
-			std::cerr << "FAILURE: Did not make a move!\n";
-			exit(1);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		}
-		catch(...) {
-			std::cerr << "FAILURE: Exception caught!\n";
+
+		field::size_type index = 0;
+		while(game_interface[index] != field::tile::empty) {
+			++index;
+		}
+		game_interface.make_move(index);
+	}
+
+	std::chrono::milliseconds delay;
+	unsigned cancelled_moves;
+};
+
+struct test_ultimate_player : ultimate_player {
+	/**
+	 * Creates a new ultimate tic-tac-toe test player that plays random legal
+	 * moves.
+	 */
+	test_ultimate_player(unsigned seed)
+	: gen(seed) {
+		std::stringstream namebuilder;
+		namebuilder << "test_ultimate_player(" << seed << ") @ " << static_cast<const void *>(this);
+		playername = namebuilder.str();
+	}
+
+	std::string name() const override {
+		return playername;
+	}
+
+	void make_move(ultimate_make_move_interface game_interface) override {
+		field::size_type moves[ultimate_position::size];
+		const field::size_type num_moves = game_interface.position().legal_moves(moves);
+		if (0 == num_moves) {
+			std::cerr << "FAILURE: No legal move left!\n";
 			exit(1);
 		}
+		game_interface.make_move(moves[std::uniform_int_distribution<field::size_type>(0, num_moves - 1)(gen)]);
 	}
 
 	std::string playername;
-	std::vector<field::size_type> moves;
-	std::vector<field::size_type>::iterator next_move;
+	std::mt19937 gen;
 };
 
-int main() {
+/**
+ * Solves small fields under the given rules by plain minimax over field,
+ * independently of field_position and the search engines.
+ */
+template<typename rules_type>
+struct variant_solver {
+	/**
+	 * Returns 1 if the player to move wins, -1 if they lose and 0 if the game
+	 * is a draw with perfect play.
+	 */
+	int solve(field &position, field::tile current_player) {
+		std::uint64_t key = (current_player == field::tile::player2);
+		field::size_type empty_tiles = 0;
+		for(field::size_type index = 0; index < position.size(); ++index) {
+			key = key * 3 + static_cast<std::uint64_t>(position[index]);
+			empty_tiles += (position[index] == field::tile::empty);
+		}
+		const auto found = memo.find(key);
+		if (found != memo.end()) {
+			return found->second;
+		}
+
+		const field::tile opponent = (current_player == field::tile::player1)
+			? field::tile::player2
+			: field::tile::player1;
+		int best = -1;
+		for(field::size_type index = 0; index < position.size() && best < 1; ++index) {
+			if (position[index] != field::tile::empty) {
+				continue;
+			}
+			for(unsigned choice = 0; choice < rules_type::choices; ++choice) {
+				const field::tile state = rules_type::symbol(current_player, choice);
+				position[index] = state;
+				field::tile winner = opponent;
+				bool decided = true;
+				if (position.check_win_condition(index)) {
+					winner = rules_type::line_winner(current_player, state);
+				}
+				else if (1 == empty_tiles) {
+					winner = rules_type::full_field_winner();
+				}
+				else {
+					decided = false;
+				}
+				const int value = !decided ? -solve(position, opponent) :
+					(winner == current_player) ? 1 :
+					(winner == field::tile::empty) ? 0 :
+					-1;
+				position[index] = field::tile::empty;
+				best = std::max(best, value);
+			}
+		}
+		memo[key] = best;
+		return best;
+	}
+
+	std::unordered_map<std::uint64_t, int> memo;
+};
+
+/**
+ * Checks the search engines under the given rules against variant_solver on
+ * a classic 3x3 field.
+ * \param expected The known value of the initial position for player 1.
+ * \return false after reporting a failure.
+ */
+template<typename rules_type>
+bool verify_variant(const std::string &name, int expected) {
+	variant_solver<rules_type> solver;
+	field position;
+	if (solver.solve(position, field::tile::player1) != expected) {
+		std::cerr << "FAILURE: Solved value of " << name << " is not " << expected << "!\n";
+		return false;
+	}
+
+	// the searcher proves the same values for the first two moves and only
+	// plays moves that keep them
+	transposition_table table(16);
+	basic_searcher<rules_type> engine(table);
+	auto solved_value = [](const search_result &result) {
+		return
+			(result.value > basic_searcher<rules_type>::win_bound) ? 1 :
+			(result.value < -basic_searcher<rules_type>::win_bound) ? -1 :
+			(result.value == 0) ? 0 :
+			2;
+	};
+	field_position root;
+	for(field::size_type first = 0; first <= position.size() * rules_type::choices; ++first) {
+		field_position current(root);
+		if (first < position.size() * rules_type::choices) {
+			current.make_move(rules::move_index<rules_type>(first), rules::move_symbol<rules_type>(first, field::tile::player1));
+		}
+		field tiles = current.to_field();
+		const int value = solver.solve(tiles, current.current_player());
+		const search_result result = engine.search(current, search_limits());
+
+		const field::size_type index = rules::move_index<rules_type>(result.move);
+		const field::tile state = rules::move_symbol<rules_type>(result.move, current.current_player());
+		current.make_move(index, state);
+		tiles[index] = state;
+		const int value_after =
+			(current.game_status() == field_position::status::ongoing) ? -solver.solve(tiles, current.current_player()) :
+			(rules::winner<rules_type>(current.opponent_player(), current.game_status()) == current.opponent_player()) ? 1 :
+			(rules::winner<rules_type>(current.opponent_player(), current.game_status()) == field::tile::empty) ? 0 :
+			-1;
+		if (solved_value(result) != value || value_after != value) {
+			std::cerr << "FAILURE: Search of " << name << " disagrees with the solver!\n";
+			return false;
+		}
+	}
+
+	// the simulated search player never does worse than the solved value
+	simulation::basic_search_player<rules_type> perfect;
+	for(unsigned seed = 0; seed < 20; ++seed) {
+		simulation::random_player random_moves(seed);
+		const bool second = seed % 2;
+		const field::tile winner = second
+			? simulation::game<rules_type>(random_moves, perfect)
+			: simulation::game<rules_type>(perfect, random_moves);
+		const field::tile perfect_state = second ? field::tile::player2 : field::tile::player1;
+		const int perfect_value = second ? -expected : expected;
+		if (
+			(0 <= perfect_value && winner != field::tile::empty && winner != perfect_state) ||
+			(0 < perfect_value && winner != perfect_state)
+		) {
+			std::cerr << "FAILURE: Simulated search player does worse than the solved value of " << name << "!\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, const char * const argv[]) {
+#ifndef _WIN32
+	// the sharding tests start copies of this program as workers
+	if (2 == argc && std::string("--worker") == argv[1]) {
+		return serve_shards(0, 1) ? 0 : 1;
+	}
+#endif
 	field::size_type stats[3] = {0, 0, 0};
 
 	{ std::vector<field::size_type> pattern = {9, 7, 5, 3, 1};
@@ -120,6 +353,804 @@ int main() {
 		}
 	}
 
+	{ // make_move / unmake_move keep the position in sync with a field
+		std::mt19937 gen(42);
+		for(unsigned game_number = 0; game_number < 100; ++game_number) {
+			field_position position(4, 3);
+			field reference(4, 3);
+			const std::uint64_t initial_hash = position.hash();
+
+			while(position.game_status() == field_position::status::ongoing) {
+				field::size_type move;
+				do {
+					move = std::uniform_int_distribution<field::size_type>(0, position.size() - 1)(gen);
+				} while(!position.is_legal(move));
+
+				const field::tile player = position.current_player();
+				reference[move] = player;
+				position.make_move(move);
+
+				const bool won = reference.check_win_condition(move);
+				if (
+					position.hash() != searcher::hash(reference, position.current_player()) ||
+					won != (position.game_status() == field_position::status::player1_won || position.game_status() == field_position::status::player2_won)
+				) {
+					std::cerr << "FAILURE: field_position out of sync after make_move!\n";
+					return 1;
+				}
+			}
+
+			while(position.moves_played()) {
+				position.unmake_move();
+			}
+			if (position.hash() != initial_hash || !position.to_field().empty() || position.game_status() != field_position::status::ongoing) {
+				std::cerr << "FAILURE: unmake_move did not restore the position!\n";
+				return 1;
+			}
+		}
+	}
+
+	{ // the incremental pattern evaluator agrees with a full evaluation
+		std::mt19937 gen(7);
+		const field::size_type geometries[][2] = { {4, 3}, {7, 4}, {15, 5} };
+		for(const auto &geometry : geometries) {
+			for(unsigned game_number = 0; game_number < 5; ++game_number) {
+				field_position position(geometry[0], geometry[1]);
+				pattern_evaluator evaluator(position);
+
+				while(position.game_status() == field_position::status::ongoing) {
+					field::size_type move;
+					do {
+						move = std::uniform_int_distribution<field::size_type>(0, position.size() - 1)(gen);
+					} while(!position.is_legal(move));
+					evaluator.make_move(move, position.current_player());
+					position.make_move(move);
+
+					const field reference = position.to_field();
+					bool threats_match = true;
+					for(field::size_type index = 0; index < position.size(); ++index) {
+						for(const field::tile player : { field::tile::player1, field::tile::player2 }) {
+							threats_match = threats_match && evaluator.is_threat(player, index) == (
+								position[index] == field::tile::empty &&
+								reference.check_win_condition(index, player)
+							);
+						}
+					}
+					if (
+						evaluator.evaluate(position.current_player()) != searcher::evaluate(position) ||
+						(position.game_status() == field_position::status::ongoing && !threats_match)
+					) {
+						std::cerr << "FAILURE: Pattern evaluator out of sync after make_move!\n";
+						return 1;
+					}
+				}
+
+				while(position.moves_played()) {
+					evaluator.unmake_move(position.last_move());
+					position.unmake_move();
+				}
+				if (
+					evaluator.evaluate(field::tile::player1) != 0 ||
+					evaluator.threats(field::tile::player1) != 0 || evaluator.threats(field::tile::player2) != 0 ||
+					evaluator.patterns(field::tile::player1, 1) != 0
+				) {
+					std::cerr << "FAILURE: Pattern evaluator not restored by unmake_move!\n";
+					return 1;
+				}
+			}
+		}
+
+		// an open four on 15x15 with 5 in a row has to be completed or blocked
+		field_position four(15, 5);
+		for(const field::size_type move : { 18u, 100u, 19u, 101u, 20u, 200u, 21u }) {
+			four.make_move(move);
+		}
+		pattern_evaluator evaluator(four);
+		std::vector<field::size_type> forced;
+		const bool is_forced = evaluator.forced_moves(four.current_player(), forced);
+		if (!is_forced || forced != std::vector<field::size_type>{ 17, 22 } || evaluator.patterns(field::tile::player1, 4) != 2) {
+			std::cerr << "FAILURE: Open four is not blocked!\n";
+			return 1;
+		}
+
+		transposition_table table(16);
+		searcher engine(table);
+		search_limits limits;
+		limits.max_depth = 4;
+		const search_result result = engine.search(four, limits);
+		if (result.value >= -searcher::win_bound || result.nodes > 10000) {
+			std::cerr << "FAILURE: Open four on 15x15 is not a loss!\n";
+			return 1;
+		}
+	}
+
+	{ // statically dispatched games
+		simulation::search_player perfect;
+		for(unsigned seed = 0; seed < 100; ++seed) {
+			simulation::random_player random_moves(seed);
+			const field::tile winner = (seed % 2)
+				? simulation::game(random_moves, perfect)
+				: simulation::game(perfect, random_moves);
+			if (winner == ((seed % 2) ? field::tile::player1 : field::tile::player2)) {
+				std::cerr << "FAILURE: Simulated search player loses!\n";
+				return 1;
+			}
+		}
+
+		// the same players through the virtual interface play the same games
+		game_settings settings;
+		settings.order = 4;
+		settings.win_length = 3;
+		for(unsigned seed = 0; seed < 10; ++seed) {
+			simulation::random_player static1(seed), static2(seed + 1000), wrapped1(seed), wrapped2(seed + 1000);
+			simulation::dynamic_player<simulation::random_player> dynamic1(wrapped1, "random 1"), dynamic2(wrapped2, "random 2");
+
+			game_outcome static_outcome, dynamic_outcome;
+			const field::tile static_winner = simulation::game(static1, static2, settings, &static_outcome);
+			const player *dynamic_winner = game(dynamic1, dynamic2, settings, &dynamic_outcome);
+			const field::tile expected_winner =
+				(dynamic_winner == &dynamic1) ? field::tile::player1 :
+				(dynamic_winner == &dynamic2) ? field::tile::player2 :
+				field::tile::empty;
+			if (static_winner != expected_winner || static_outcome != dynamic_outcome) {
+				std::cerr << "FAILURE: Simulated game differs from the interactive game!\n";
+				return 1;
+			}
+		}
+
+		struct cheating_player {
+			void make_move(simulation::move_interface &game) {
+				game.make_move(0);
+			}
+		} cheater1, cheater2;
+		game_outcome outcome;
+		if (simulation::game(cheater1, cheater2, game_settings(), &outcome) != field::tile::player1 || outcome != game_outcome::rule_violation) {
+			std::cerr << "FAILURE: Simulated rule violation is not detected!\n";
+			return 1;
+		}
+	}
+
+	{ // lockstep self-play
+		table_policy computer_moves;
+		self_play_driver classic(3, 3, 100);
+		const self_play_statistics perfect = classic.run(computer_moves, 1000);
+		if (perfect.games != 1000 || perfect.draws != 1000 || perfect.moves != 9000 || perfect.steps != 90) {
+			std::cerr << "FAILURE: Computer player self-play is not always a draw!\n";
+			return 1;
+		}
+
+		// the batch is refilled and compacted, and every game is recorded
+		random_policy random_moves(42);
+		self_play_driver driver(4, 3, 64);
+		std::stringstream records;
+		game_records::write_header(records, 4, 3);
+		const self_play_statistics stats = driver.run(random_moves, 1000, &records);
+		const game_statistics replayed = analyze_game_records(records, 1, 1);
+		if (
+			stats.games != 1000 || stats.player1_wins + stats.player2_wins + stats.draws != 1000 ||
+			replayed.corrupt_games != 0 || replayed.results.games != 1000 || replayed.moves != stats.moves ||
+			replayed.results.player1_wins != stats.player1_wins || replayed.results.draws != stats.draws
+		) {
+			std::cerr << "FAILURE: Self-play records do not match the statistics!\n";
+			return 1;
+		}
+	}
+
+	{ // exhaustive searches of known positions
+		transposition_table table(16);
+		searcher engine(table);
+
+		const search_result classic = engine.search(field(), field::tile::player1, search_limits());
+		if (classic.value != 0) {
+			std::cerr << "FAILURE: Tic-tac-toe is not a draw!\n";
+			return 1;
+		}
+
+		const search_result four_by_four = engine.search(field(4, 3), field::tile::player1, search_limits());
+		if (four_by_four.value <= searcher::win_bound || four_by_four.principal_variation.size() != 5) {
+			std::cerr << "FAILURE: 4x4 with 3 in a row is not a win in 5 moves!\n";
+			return 1;
+		}
+
+		table.clear();
+		parallel_searcher parallel_engine(table, 4);
+		const search_result parallel = parallel_engine.search(field(4, 3), field::tile::player1, search_limits());
+		if (parallel.value != four_by_four.value) {
+			std::cerr << "FAILURE: Parallel search disagrees!\n";
+			return 1;
+		}
+
+		const std::atomic<bool> cancelled(true);
+		search_limits cancelled_limits;
+		cancelled_limits.stop = &cancelled;
+		const search_result cancelled_result = parallel_engine.search(field(5, 4), field::tile::player1, cancelled_limits);
+		if (cancelled_result.depth != 0 || field(5, 4)[cancelled_result.move] != field::tile::empty) {
+			std::cerr << "FAILURE: Cancelled search did not return immediately!\n";
+			return 1;
+		}
+	}
+
+	{ // rule variants, verified by an independent solver
+		if (
+			!verify_variant<rules::standard>("tic-tac-toe", 0) ||
+			!verify_variant<rules::misere>("misere tic-tac-toe", 0) ||
+			!verify_variant<rules::wild>("wild tic-tac-toe", 1) ||
+			!verify_variant<rules::order_and_chaos>("Order and Chaos on 3x3", 1)
+		) {
+			return 1;
+		}
+	}
+
+	{ // proof-number search and independently checked proof trees
+		proof_solver solver(1 << 20);
+		if (solver.solve(field_position()) != proof_result::draw || solver.solve(field_position(4, 3)) != proof_result::win) {
+			std::cerr << "FAILURE: Proof-number search got known results wrong!\n";
+			return 1;
+		}
+
+		// a table of a single bucket still solves, only slower
+		proof_solver tiny(1);
+		if (tiny.solve(field_position(4, 3)) != proof_result::win || tiny.statistics().table_entries > 4) {
+			std::cerr << "FAILURE: Proof-number search with a tiny table failed!\n";
+			return 1;
+		}
+
+		std::stringstream draw_proof, win_proof;
+		solver.write_proof(draw_proof, field_position(), field::tile::player1);
+		solver.write_proof(draw_proof, field_position(), field::tile::player2);
+		solver.write_proof(win_proof, field_position(4, 3), field::tile::player1);
+		const proof_claim no_win1 = check_proof(draw_proof), no_win2 = check_proof(draw_proof), win = check_proof(win_proof);
+		if (
+			no_win1.attacker_wins || no_win1.attacker != field::tile::player1 ||
+			no_win2.attacker_wins || no_win2.attacker != field::tile::player2 ||
+			!win.attacker_wins || win.position.order() != 4 || win.nodes == 0
+		) {
+			std::cerr << "FAILURE: Proof trees do not prove their results!\n";
+			return 1;
+		}
+
+		// claiming the opposite or dropping a node breaks the proof
+		std::string tree = win_proof.str();
+		std::string wrong_claim = tree, missing_node = tree;
+		wrong_claim.replace(wrong_claim.find(" X X win"), 8, " X O win");
+		const std::size_t second_node = missing_node.find('\n', missing_node.find('\n') + 1) + 1;
+		missing_node.erase(second_node, missing_node.find('\n', second_node) + 1 - second_node);
+		for(const std::string &broken : { wrong_claim, missing_node }) {
+			std::stringstream input(broken);
+			bool rejected = false;
+			try {
+				check_proof(input);
+			}
+			catch(std::runtime_error &) {
+				rejected = true;
+			}
+			if (!rejected) {
+				std::cerr << "FAILURE: Broken proof tree was accepted!\n";
+				return 1;
+			}
+		}
+	}
+
+	if (tracing::available()) { // sampled trace spans in the Chrome trace format
+		transposition_table table(16);
+		searcher engine(table);
+		tracing::start();
+		engine.search(field(), field::tile::player1, search_limits());
+		{
+			tracing::span outer("outer");
+			tracing::instant("inside");
+			std::stringstream discarded;
+			field().print(discarded);
+		}
+		tracing::stop();
+		engine.search(field(), field::tile::player1, search_limits());
+
+		std::stringstream trace;
+		const std::size_t spans = tracing::write_chrome_trace(trace);
+		const std::string json = trace.str();
+		if (
+			json.find("\"name\":\"searcher::search\",\"cat\":\"tictactoe\",\"ph\":\"X\"") == std::string::npos ||
+			json.find("\"searcher::iteration\"") == std::string::npos ||
+			json.find("\"name\":\"field::print\"") == std::string::npos ||
+			json.find("\"name\":\"inside\",\"cat\":\"tictactoe\",\"ph\":\"i\"") == std::string::npos ||
+			json.find("\"traceEvents\":[") != 1 || json.find("\"displayTimeUnit\":\"ms\"}") == std::string::npos ||
+			json.find("searcher::search") != json.rfind("searcher::search") ||
+			spans < 4
+		) {
+			std::cerr << "FAILURE: Trace does not contain the traced spans!\n";
+			return 1;
+		}
+
+		// half of the outermost spans, with everything nested in them
+		tracing::start(0.5);
+		for(unsigned i = 0; i < 10; ++i) {
+			tracing::span outer("outer");
+			tracing::span inner("inner");
+		}
+		tracing::stop();
+		std::stringstream sampled;
+		if (tracing::write_chrome_trace(sampled) != 10) {
+			std::cerr << "FAILURE: Trace sampling is off!\n";
+			return 1;
+		}
+
+		// a full ring buffer keeps the most recent spans
+		tracing::start(1, 4);
+		for(const char *name : { "first", "second", "third", "fourth", "fifth" }) {
+			tracing::span recent(name);
+		}
+		tracing::stop();
+		std::stringstream recent;
+		tracing::write_chrome_trace(recent);
+		if (recent.str().find("\"first\"") != std::string::npos || recent.str().find("\"fifth\"") == std::string::npos) {
+			std::cerr << "FAILURE: Trace ring buffer does not keep the most recent spans!\n";
+			return 1;
+		}
+	}
+
+	{ // searches on larger boards stay within the time limit of the match
+		game_settings settings;
+		settings.order = 5;
+		settings.win_length = 4;
+		settings.move_time = std::chrono::milliseconds(50);
+
+		computer_player computer1, computer2;
+		timed_player timed1(computer1), timed2(computer2);
+		game_outcome outcome;
+		game(timed1, timed2, settings, &outcome);
+		if (outcome == game_outcome::timeout) {
+			std::cerr << "FAILURE: Computer player ran out of time!\n";
+			return 1;
+		}
+
+		std::cout <<
+			"Longest moves with a limit of " << settings.move_time.count() << "ms: " <<
+			std::chrono::duration_cast<std::chrono::milliseconds>(timed1.longest_move).count() << "ms, " <<
+			std::chrono::duration_cast<std::chrono::milliseconds>(timed2.longest_move).count() << "ms\n";
+	}
+
+	{ // players exceeding their time lose
+		game_settings settings;
+		settings.order = 4;
+		settings.move_time = std::chrono::milliseconds(20);
+		game_outcome outcome;
+
+		// a stalled player is cancelled by the watchdog
+		slow_player stalled(std::chrono::milliseconds(0)), fast(std::chrono::milliseconds(1));
+		const auto start = std::chrono::steady_clock::now();
+		player *winner = game(stalled, fast, settings, &outcome);
+		if (winner != &fast || outcome != game_outcome::timeout || stalled.cancelled_moves != 1 || std::chrono::steady_clock::now() - start > std::chrono::seconds(1)) {
+			std::cerr << "FAILURE: Stalled player was not cancelled!\n";
+			return 1;
+		}
+
+		// the game clock runs out after a few moves; without it, player 1
+		// wins the fourth column
+		settings.move_time = std::chrono::milliseconds(0);
+		settings.game_time = std::chrono::milliseconds(50);
+		slow_player slow1(std::chrono::milliseconds(15)), slow2(std::chrono::milliseconds(1));
+		winner = game(slow1, slow2, settings, &outcome);
+		if (winner != &slow2 || outcome != game_outcome::timeout) {
+			std::cerr << "FAILURE: Game clock was not enforced!\n";
+			return 1;
+		}
+
+		settings.game_time = std::chrono::milliseconds(0);
+		winner = game(slow1, slow2, settings, &outcome);
+		if (winner != &slow1 || outcome != game_outcome::won) {
+			std::cerr << "FAILURE: Untimed game was not won!\n";
+			return 1;
+		}
+	}
+
+	{ // observers follow the start, every move and the end of a game
+		struct recording_observer : game_observer {
+			void start_game(const field &position) override {
+				events.push_back(position.size());
+			}
+			void move(const field &, field::size_type index) override {
+				events.push_back(index);
+			}
+			void end_game(field::tile winner) override {
+				events.push_back(100 + static_cast<unsigned>(winner));
+			}
+
+			std::vector<unsigned> events;
+		} observer;
+
+		// both players take the first empty tile, so player 1 wins the
+		// diagonal 2, 4, 6
+		game_settings settings;
+		settings.observer = &observer;
+		slow_player first(std::chrono::milliseconds(1)), second(std::chrono::milliseconds(1));
+		game(first, second, settings);
+		if (observer.events != std::vector<unsigned>{ 9, 0, 1, 2, 3, 4, 5, 6, 101 }) {
+			std::cerr << "FAILURE: Observer did not follow the game!\n";
+			return 1;
+		}
+	}
+
+#ifndef _WIN32
+	{ // spectators get every move, slow ones skip forward to a keyframe
+		int fast[2], slow[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fast) || socketpair(AF_UNIX, SOCK_STREAM, 0, slow)) {
+			std::cerr << "FAILURE: Cannot create sockets for spectators!\n";
+			return 1;
+		}
+		const int small_buffer = 4096;
+		setsockopt(slow[0], SOL_SOCKET, SO_SNDBUF, &small_buffer, sizeof(small_buffer));
+
+		auto receive_all = [](int socket, std::string &received) {
+			char buffer[4096];
+			for(ssize_t length; 0 < (length = read(socket, buffer, sizeof(buffer))); ) {
+				received.append(buffer, length);
+			}
+			close(socket);
+		};
+		std::string fast_frames, slow_frames;
+		std::thread fast_reader(receive_all, fast[1], std::ref(fast_frames)), slow_reader;
+
+		field last_game;
+		spectator_broadcaster::statistics stats;
+		bool flushed;
+		{
+			spectator_broadcaster::settings broadcast_settings;
+			broadcast_settings.keyframe_interval = 4;
+			broadcast_settings.history_size = 16384;
+			spectator_broadcaster spectators(broadcast_settings);
+			spectators.subscribe(fast[0]);
+			spectators.subscribe(slow[0]);
+
+			// the slow spectator does not read until all games are over
+			std::mt19937 random(42);
+			for(unsigned game_number = 0; game_number < 5000; ++game_number) {
+				field position;
+				spectators.start_game(position);
+				field::tile player = field::tile::player1, winner = field::tile::empty;
+				for(field::size_type moves = 0; moves < position.size() && winner == field::tile::empty; ++moves) {
+					field::size_type index;
+					do {
+						index = random() % position.size();
+					} while(position[index] != field::tile::empty);
+					position[index] = player;
+					spectators.move(position, index);
+					winner = position.check_win_condition(index) ? player : field::tile::empty;
+					player = (player == field::tile::player1) ? field::tile::player2 : field::tile::player1;
+				}
+				spectators.end_game(winner);
+				last_game = position;
+			}
+			slow_reader = std::thread(receive_all, slow[1], std::ref(slow_frames));
+			flushed = spectators.flush(std::chrono::seconds(10));
+			stats = spectators.stats();
+		}
+		fast_reader.join();
+		slow_reader.join();
+
+		spectator_view fast_view, slow_view;
+		std::stringstream fast_input(fast_frames), slow_input(slow_frames);
+		std::uint64_t fast_count = 0;
+		try {
+			while(read_spectator_frame(fast_input, fast_view)) {
+				++fast_count;
+			}
+			while(read_spectator_frame(slow_input, slow_view)) {}
+		}
+		catch(std::runtime_error &e) {
+			std::cerr << "FAILURE: Spectator received broken frames: " << e.what() << "\n";
+			return 1;
+		}
+		bool same_result = fast_view.game_over && slow_view.game_over;
+		for(field::size_type index = 0; index < last_game.size(); ++index) {
+			same_result = same_result && fast_view.position[index] == last_game[index] && slow_view.position[index] == last_game[index];
+		}
+		if (!flushed || !same_result || fast_count != stats.frames || fast_view.skipped_frames != 0) {
+			std::cerr << "FAILURE: Spectators did not see all games!\n";
+			return 1;
+		}
+		if (slow_view.skipped_frames == 0 || stats.skipped_frames != slow_view.skipped_frames || stats.subscribers != 2) {
+			std::cerr << "FAILURE: Slow spectator did not skip forward!\n";
+			return 1;
+		}
+	}
+
+	{ // spectators connect to the socket that replaced the previous one
+		const std::string first_path = "testtictactoe-first.sock", second_path = "testtictactoe-second.sock";
+		spectator_broadcaster spectators;
+		spectators.listen(first_path);
+		spectators.listen(second_path);
+
+		sockaddr_un address;
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		std::strcpy(address.sun_path, second_path.c_str());
+		const int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		const bool connected = 0 <= socket && 0 == connect(socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+
+		// wait until the spectator has been accepted
+		for(unsigned wait = 0; connected && wait < 1000 && spectators.stats().subscribers == 0; ++wait) {
+			spectators.start_game(field());
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		spectators.start_game(field());
+		const bool flushed = spectators.flush(std::chrono::seconds(10));
+		unlink(first_path.c_str());
+		unlink(second_path.c_str());
+
+		char kind = 0;
+		const bool received = connected && 1 == read(socket, &kind, 1);
+		if (0 <= socket) {
+			close(socket);
+		}
+		if (!received || !flushed || kind != 1 || spectators.stats().subscribers != 1) {
+			std::cerr << "FAILURE: Spectator could not connect to the replacing socket!\n";
+			return 1;
+		}
+	}
+#endif
+
+#ifndef _WIN32
+	{ // sharded runs on worker processes agree with a single process
+		shard_coordinator::settings settings;
+		settings.workers = 3;
+		settings.shard_size = 50;
+		shard_coordinator coordinator(settings);
+		const shard_result patterns = coordinator.run(shard_job());
+		std::uint64_t worker_shards = 0;
+		for(const std::uint64_t shards : coordinator.stats().worker_shards) {
+			worker_shards += shards;
+		}
+		if (
+			patterns.games != stats[0] + stats[1] + stats[2] || patterns.wins != stats[2] ||
+			patterns.draws != stats[1] || patterns.losses != stats[0] ||
+			coordinator.stats().shards != 27 || worker_shards != 27
+		) {
+			std::cerr << "FAILURE: Sharded pattern games differ from the tests!\n";
+			return 1;
+		}
+
+		// a shallow search loses some games, which are reported
+		shard_job random_games;
+		random_games.type = shard_job::kind::random;
+		random_games.games = 200;
+		settings.workers = 2;
+		settings.shard_size = 7;
+		shard_coordinator random_coordinator(settings);
+		const shard_result expected = run_shard(random_games, 0, random_games.games);
+		auto same_as_expected = [&expected](const shard_result &sharded) {
+			bool same_reports = expected.losses != 0 && sharded.loss_reports.size() == expected.loss_reports.size();
+			for(std::size_t index = 0; same_reports && index < expected.loss_reports.size(); ++index) {
+				same_reports =
+					sharded.loss_reports[index].unit == expected.loss_reports[index].unit &&
+					sharded.loss_reports[index].moves == expected.loss_reports[index].moves;
+			}
+			return
+				same_reports && sharded.games == expected.games && sharded.wins == expected.wins &&
+				sharded.draws == expected.draws && sharded.losses == expected.losses;
+		};
+		if (!same_as_expected(random_coordinator.run(random_games))) {
+			std::cerr << "FAILURE: Sharded random games differ from a single process!\n";
+			return 1;
+		}
+
+		settings.worker_command = "exit 1";
+		shard_coordinator failing_coordinator(settings);
+		bool failed = false;
+		try {
+			failing_coordinator.run(random_games);
+		}
+		catch(std::runtime_error &) {
+			failed = true;
+		}
+		if (!failed || failing_coordinator.stats().failed_workers != 2) {
+			std::cerr << "FAILURE: Failing workers were not detected!\n";
+			return 1;
+		}
+
+		// one of the workers stalls before its first shard; the others
+		// run a copy of that shard and finish without it
+		const std::string worker_command = std::string("exec '") + argv[0] + "' --worker";
+		settings.workers = 3;
+		settings.worker_command = "if mkdir testtictactoe-straggler 2>/dev/null; then sleep 3 2>/dev/null; fi; " + worker_command;
+		shard_coordinator straggling_coordinator(settings);
+		const shard_result straggled = straggling_coordinator.run(random_games);
+		rmdir("testtictactoe-straggler");
+		if (
+			!same_as_expected(straggled) || straggling_coordinator.stats().speculated == 0 ||
+			straggling_coordinator.stats().elapsed >= std::chrono::seconds(3)
+		) {
+			std::cerr << "FAILURE: Straggling worker was not worked around!\n";
+			return 1;
+		}
+
+		// one of the workers dies with its first shard, which is
+		// handed out again
+		settings.speculate = false;
+		settings.worker_command = "if mkdir testtictactoe-crash 2>/dev/null; then read shard; exit 1; fi; " + worker_command;
+		shard_coordinator crashing_coordinator(settings);
+		const shard_result crashed = crashing_coordinator.run(random_games);
+		rmdir("testtictactoe-crash");
+		const shard_coordinator::statistics &crash_stats = crashing_coordinator.stats();
+		if (
+			!same_as_expected(crashed) || crash_stats.failed_workers != 1 ||
+			crash_stats.dispatched != crash_stats.shards + 1
+		) {
+			std::cerr << "FAILURE: Shard of a crashed worker was not handed out again!\n";
+			return 1;
+		}
+	}
+#endif
+
+	{ // symmetries are undone by their inverse
+		for(field::size_type order = 3; order <= 4; ++order) {
+			for(unsigned transformation = 0; transformation < symmetry::count; ++transformation) {
+				for(field::size_type index = 0; index < order * order; ++index) {
+					const field::size_type transformed = symmetry::transform_index(order, index, transformation);
+					if (index != symmetry::transform_index(order, transformed, symmetry::inverse(transformation))) {
+						std::cerr << "FAILURE: Symmetry is not undone by its inverse!\n";
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	{ // evaluation service answers batches in wire format, folding symmetries
+		const field::tile X = field::tile::player1, O = field::tile::player2, _ = field::tile::empty;
+		const field position = { // has no symmetries of its own
+			X, _, _,
+			_, _, O,
+			_, _, _
+		};
+		std::vector<evaluation_query> queries = {
+			{ 1, field(), X },
+			{ 2, position, X },
+			{ 3, symmetry::transform(position, 3), X },
+			{ 4, symmetry::transform(position, 6), X },
+			{ 5, { X, X, X, O, O, _, _, _, _ }, O }
+		};
+
+		std::stringstream requests, responses;
+		for(const auto &query : queries) {
+			write_query(requests, query);
+		}
+		evaluation_service::settings settings;
+		settings.threads = 2;
+		evaluation_service service(settings);
+		service.run(requests, responses);
+
+		// the empty field, position and the won position are evaluated
+		std::vector<evaluation_answer> answers;
+		evaluation_answer answer;
+		while(read_answer(responses, answer)) {
+			answers.push_back(answer);
+		}
+
+		if (
+			answers.size() != queries.size() ||
+			service.stats().evaluations != 3 ||
+			answers[0].result != evaluation_answer::status::ok || answers[0].value != 0 ||
+			answers[4].result != evaluation_answer::status::invalid
+		) {
+			std::cerr << "FAILURE: Evaluation service gave wrong answers!\n";
+			return 1;
+		}
+		for(std::size_t index = 1; index < 4; ++index) {
+			const unsigned transformation = (1 == index) ? 0 : (2 == index) ? 3 : 6;
+			if (
+				answers[index].id != queries[index].id ||
+				answers[index].value != answers[1].value ||
+				answers[index].move != symmetry::transform_index(3, answers[1].move, transformation) ||
+				queries[index].position[answers[index].move] != field::tile::empty
+			) {
+				std::cerr << "FAILURE: Evaluation service did not fold symmetries!\n";
+				return 1;
+			}
+		}
+	}
+
+	{ // evaluation service bounds searches on large fields without explicit limits
+		std::stringstream requests, responses;
+		write_query(requests, { 1, field(7, 4), field::tile::player1 });
+		evaluation_service::settings settings;
+		settings.threads = 1;
+		settings.large_field_time = std::chrono::milliseconds(50);
+		evaluation_service service(settings);
+		service.run(requests, responses);
+
+		evaluation_answer answer;
+		if (!read_answer(responses, answer) || answer.result != evaluation_answer::status::ok || answer.depth == 0) {
+			std::cerr << "FAILURE: Evaluation service did not answer a query on a large field!\n";
+			return 1;
+		}
+	}
+
+	{ // replay stored games, folding symmetric openings
+		const std::vector<std::vector<field::size_type>> games = {
+			{ 0, 3, 1, 4, 2 },             // player 1 wins
+			{ 2, 5, 1, 4, 0 },             // the same game mirrored
+			{ 4, 0, 1, 3, 2, 6 },          // player 2 wins
+			{ 0, 4, 8, 2, 6, 3, 5, 7, 1 }, // draw
+			{ 0, 0 },                      // corrupt: tile taken
+			{ 0, 3, 1, 4, 2, 5 }           // corrupt: move after the win
+		};
+		std::stringstream records;
+		game_records::write_header(records, 3, 3);
+		for(const auto &moves : games) {
+			game_records::write_game(records, moves.data(), moves.size());
+		}
+		const std::string data = records.str();
+
+		const game_statistics stats[] = {
+			analyze_game_records(records, 2, 2),
+			analyze_game_records(reinterpret_cast<const unsigned char *>(data.data()), data.size(), 2, 2)
+		};
+		for(const auto &result : stats) {
+			std::uint64_t mirrored_opening = 0, corner_opening = 0;
+			for(const auto &entry : result.openings) {
+				if (entry.second.line == std::vector<std::uint8_t>{ 0, 3 } || entry.second.line == std::vector<std::uint8_t>{ 2, 5 }) {
+					mirrored_opening = entry.second.results.games;
+				}
+				if (entry.second.line == std::vector<std::uint8_t>{ 0 } || entry.second.line == std::vector<std::uint8_t>{ 2 }) {
+					corner_opening = entry.second.results.games;
+				}
+			}
+			if (
+				result.results.games != 4 || result.corrupt_games != 2 ||
+				result.results.player1_wins != 2 || result.results.player2_wins != 1 || result.results.draws != 1 ||
+				result.moves != 25 || result.heatmap[0][0] != 3 || result.heatmap[1][4] != 3 ||
+				result.first_moves[0].games != 2 || result.first_moves[4].player2_wins != 1 ||
+				mirrored_opening != 2 || corner_opening != 3
+			) {
+				std::cerr << "FAILURE: Game record analytics are wrong!\n";
+				return 1;
+			}
+		}
+
+		bool truncation_detected = false;
+		try {
+			analyze_game_records(reinterpret_cast<const unsigned char *>(data.data()), data.size() - 1, 1, 2);
+		}
+		catch(std::runtime_error &) {
+			truncation_detected = true;
+		}
+		if (!truncation_detected) {
+			std::cerr << "FAILURE: Truncated game records were accepted!\n";
+			return 1;
+		}
+	}
+
+	{ field::size_type ultimate_stats[3] = {0, 0, 0};
+		for(unsigned seed = 0; seed < 20; ++seed) {
+			// single threaded fixed depth search is deterministic, the last
+			// games exercise the multi-threaded search under a time budget
+			ultimate_computer_player computer = (seed < 16)
+				? ultimate_computer_player(1, std::chrono::milliseconds(60000), 3)
+				: ultimate_computer_player(4, std::chrono::milliseconds(50));
+			test_ultimate_player tester(seed);
+			ultimate_player *winner = (seed % 2)
+				? ultimate_game(tester, computer)
+				: ultimate_game(computer, tester);
+
+			++ultimate_stats[
+				1
+				+(winner == &computer)
+				-(winner == &tester)
+			];
+
+			if (winner == &tester) {
+				std::cerr << "FAILURE: Ultimate computer loses!\n";
+				return 1;
+			}
+		}
+
+		std::cout <<
+			"Ultimate stats:\n"
+			"  Tester wins: " << ultimate_stats[0] << "\n"
+			"  Draw game:   " << ultimate_stats[1] << "\n"
+			"  CPU wins:    " << ultimate_stats[2] << "\n";
+	}
+
 	std::cout <<
 		"Stats:\n"
 		"  Tester wins: " << stats[0] << "\n"
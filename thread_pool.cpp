@@ -0,0 +1,52 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+tictactoe::thread_pool::thread_pool(unsigned threads)
+: stopping(false) {
+	if (0 == threads) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	workers.reserve(threads);
+	for(unsigned index = 0; index < threads; ++index) {
+		workers.emplace_back(&thread_pool::work, this);
+	}
+}
+
+tictactoe::thread_pool::~thread_pool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeup.notify_all();
+	for(auto &worker : workers) {
+		worker.join();
+	}
+}
+
+std::future<void> tictactoe::thread_pool::submit(std::function<void()> task) {
+	std::packaged_task<void()> packaged(task);
+	std::future<void> result = packaged.get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.emplace_back(std::move(packaged));
+	}
+	wakeup.notify_one();
+	return result;
+}
+
+void tictactoe::thread_pool::work() {
+	for(;;) {
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeup.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (tasks.empty()) {
+				return; // stopping and nothing left to do
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef TICTACTOE_THREAD_POOL_HPP_INCLUDED
+#define TICTACTOE_THREAD_POOL_HPP_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tictactoe {
+
+/**
+ * A fixed number of worker threads processing tasks in submission order.
+ */
+struct thread_pool {
+	/**
+	 * Create a pool and start its workers.
+	 * \param threads The number of worker threads; 0 starts one worker per
+	 *        hardware thread.
+	 */
+	explicit thread_pool(unsigned threads);
+
+	/**
+	 * Finishes all submitted tasks and stops the workers.
+	 */
+	~thread_pool();
+
+	thread_pool(const thread_pool &) = delete;
+	thread_pool &operator=(const thread_pool &) = delete;
+
+	/**
+	 * Queues a task for execution by the next idle worker.
+	 * \return A future that becomes ready once the task has run. Exceptions
+	 *         thrown by the task are rethrown by std::future::get().
+	 */
+	std::future<void> submit(std::function<void()> task);
+
+	/**
+	 * Returns the number of worker threads.
+	 */
+	unsigned size() const noexcept { return static_cast<unsigned>(workers.size()); }
+
+private:
+	void work();
+
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::deque<std::packaged_task<void()>> tasks;
+	bool stopping;
+	std::vector<std::thread> workers;
+};
+
+}
+
+#endif // TICTACTOE_THREAD_POOL_HPP_INCLUDED
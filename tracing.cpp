@@ -0,0 +1,221 @@
+#include "tracing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	struct event {
+		const char *name;
+		std::int64_t start;
+		/**
+		 * The duration in nanoseconds, or -1 for an instant.
+		 */
+		std::int64_t duration;
+	};
+
+	/**
+	 * The ring buffer of a thread. Only its own thread records into it, so
+	 * the mutex is only ever contended by start() and write_chrome_trace().
+	 */
+	struct thread_buffer {
+		std::mutex mutex;
+		std::vector<event> events;
+		std::uint64_t recorded;
+		unsigned id;
+	};
+
+	struct thread_state {
+		unsigned depth;
+		bool sampled;
+		std::uint32_t countdown;
+		std::uint64_t generation;
+		std::shared_ptr<thread_buffer> buffer;
+	};
+
+	// every n-th outermost span is recorded, none while 0
+	std::atomic<std::uint32_t> sample_interval(0);
+	// incremented by start(), so every thread restarts its sampling
+	std::atomic<std::uint64_t> generation(0);
+
+	std::mutex registry_mutex;
+	std::vector<std::shared_ptr<thread_buffer>> registry;
+	std::size_t buffer_capacity = 1 << 16;
+	unsigned next_thread_id = 1;
+
+	thread_local thread_state local = { 0, false, 0, 0, nullptr };
+
+	std::int64_t now() {
+		static const clock_type::time_point epoch = clock_type::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - epoch).count();
+	}
+
+	void record(thread_state &state, const char *name, std::int64_t start, std::int64_t duration) noexcept {
+		try {
+			if (!state.buffer) {
+				std::lock_guard<std::mutex> lock(registry_mutex);
+				state.buffer = std::make_shared<thread_buffer>();
+				state.buffer->events.resize(buffer_capacity);
+				state.buffer->recorded = 0;
+				state.buffer->id = next_thread_id++;
+				registry.push_back(state.buffer);
+			}
+
+			thread_buffer &buffer = *state.buffer;
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			const event recorded = { name, start, duration };
+			buffer.events[buffer.recorded++ % buffer.events.size()] = recorded;
+		}
+		catch(...) {
+			// a span that cannot be recorded is dropped
+		}
+	}
+
+	void write_json_string(std::ostream &os, const char *text) {
+		os << '"';
+		for(; *text; ++text) {
+			if ('"' == *text || '\\' == *text) {
+				os << '\\';
+			}
+			os << *text;
+		}
+		os << '"';
+	}
+
+	// the trace format expects microseconds
+	void write_microseconds(std::ostream &os, std::int64_t nanoseconds) {
+		const char fraction[] = {
+			'.',
+			static_cast<char>('0' + nanoseconds / 100 % 10),
+			static_cast<char>('0' + nanoseconds / 10 % 10),
+			static_cast<char>('0' + nanoseconds % 10),
+			'\0'
+		};
+		os << nanoseconds / 1000 << fraction;
+	}
+}
+
+bool tictactoe::tracing::available() noexcept {
+#ifdef TICTACTOE_TRACING
+	return true;
+#else
+	return false;
+#endif
+}
+
+void tictactoe::tracing::start(double sample_rate, std::size_t buffer_size) {
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	buffer_capacity = std::max<std::size_t>(1, buffer_size);
+
+	// buffers only referenced here belong to threads that have ended
+	registry.erase(std::remove_if(registry.begin(), registry.end(), [](const std::shared_ptr<thread_buffer> &buffer) {
+		return 1 == buffer.use_count();
+	}), registry.end());
+	for(const auto &buffer : registry) {
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+		buffer->events.assign(buffer_capacity, event());
+		buffer->recorded = 0;
+	}
+
+	++generation;
+	sample_interval = (0 < sample_rate)
+		? static_cast<std::uint32_t>(std::max(1.0, std::min(4294967295.0, std::round(1 / sample_rate))))
+		: 0;
+}
+
+void tictactoe::tracing::stop() noexcept {
+	sample_interval = 0;
+}
+
+std::size_t tictactoe::tracing::write_chrome_trace(std::ostream &os) {
+	std::vector<std::pair<unsigned, std::vector<event>>> threads;
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		for(const auto &buffer : registry) {
+			std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+			const std::uint64_t
+				capacity = buffer->events.size(),
+				kept = std::min(buffer->recorded, capacity);
+			threads.emplace_back(buffer->id, std::vector<event>());
+			for(std::uint64_t index = buffer->recorded - kept; index < buffer->recorded; ++index) {
+				threads.back().second.push_back(buffer->events[index % capacity]);
+			}
+		}
+	}
+
+	std::size_t written = 0;
+	const char *separator = "\n";
+	os << "{\"traceEvents\":[";
+	for(const auto &thread : threads) {
+		os << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.first <<
+			",\"args\":{\"name\":\"thread " << thread.first << "\"}}";
+		separator = ",\n";
+
+		for(const event &recorded : thread.second) {
+			os << separator << "{\"name\":";
+			write_json_string(os, recorded.name);
+			os << ",\"cat\":\"tictactoe\",\"ph\":\"" << ((0 <= recorded.duration) ? "X" : "i") << "\",\"ts\":";
+			write_microseconds(os, recorded.start);
+			if (0 <= recorded.duration) {
+				os << ",\"dur\":";
+				write_microseconds(os, recorded.duration);
+			}
+			else {
+				os << ",\"s\":\"t\"";
+			}
+			os << ",\"pid\":1,\"tid\":" << thread.first << '}';
+			++written;
+		}
+	}
+	os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return written;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::tracing::span
+//
+
+tictactoe::tracing::span::span(const char *name) noexcept
+: name(name)
+, start(-1) {
+	thread_state &state = local;
+	if (0 == state.depth++) {
+		const std::uint64_t current_generation = generation.load(std::memory_order_relaxed);
+		if (state.generation != current_generation) {
+			state.generation = current_generation;
+			state.countdown = 0;
+		}
+
+		const std::uint32_t interval = sample_interval.load(std::memory_order_relaxed);
+		state.sampled = interval && 0 == state.countdown;
+		if (interval) {
+			state.countdown = state.countdown ? state.countdown - 1 : interval - 1;
+		}
+	}
+	if (state.sampled) {
+		start = now();
+	}
+}
+
+tictactoe::tracing::span::~span() {
+	thread_state &state = local;
+	if (0 <= start) {
+		record(state, name, start, now() - start);
+	}
+	--state.depth;
+}
+
+void tictactoe::tracing::instant(const char *name) noexcept {
+	thread_state &state = local;
+	if (state.depth && state.sampled) {
+		record(state, name, now(), -1);
+	}
+}
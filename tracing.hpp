@@ -0,0 +1,90 @@
+#ifndef TICTACTOE_TRACING_HPP_INCLUDED
+#define TICTACTOE_TRACING_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace tictactoe {
+/**
+ * Spans recording where the time of games, moves and searches goes, for
+ * viewing in chrome://tracing or Perfetto.
+ *
+ * Code is instrumented with TICTACTOE_TRACE_SPAN(name), which records the
+ * time until the end of the enclosing scope, and TICTACTOE_TRACE_INSTANT(name)
+ * for single points in time. Both expand to nothing unless the code is built
+ * with TICTACTOE_TRACING defined (make TRACING=0 leaves it undefined).
+ *
+ * Nothing is recorded until start() is called. Spans are sampled per thread:
+ * whether an outermost span is recorded is decided once, and spans nested in
+ * it follow that decision, so recorded spans always form complete trees.
+ * Unrecorded spans cost a thread local counter update. Every thread records
+ * into its own ring buffer of the most recent spans, which write_chrome_trace()
+ * exports.
+ */
+namespace tracing {
+	/**
+	 * Returns whether the tracing spans are compiled in.
+	 */
+	bool available() noexcept;
+
+	/**
+	 * Starts recording spans, discarding the spans recorded so far.
+	 * \param sample_rate The share of outermost spans recorded per thread,
+	 *        e.g. 0.01 for every 100th; 1 records all of them.
+	 * \param buffer_size The number of spans kept per thread; older spans
+	 *        are overwritten.
+	 */
+	void start(double sample_rate = 1, std::size_t buffer_size = 1 << 16);
+
+	/**
+	 * Stops recording new outermost spans; the recorded ones are kept.
+	 */
+	void stop() noexcept;
+
+	/**
+	 * Writes the recorded spans of all threads in the Chrome trace event
+	 * format (JSON), oldest first per thread.
+	 * \return The number of spans written.
+	 */
+	std::size_t write_chrome_trace(std::ostream &os);
+
+	/**
+	 * Records the time from its construction to its destruction, see
+	 * TICTACTOE_TRACE_SPAN.
+	 */
+	struct span {
+		/**
+		 * \param name The name of the span; it has to outlive the export, so
+		 *        it usually is a string literal.
+		 */
+		explicit span(const char *name) noexcept;
+		~span();
+
+		span(const span &) = delete;
+		span &operator=(const span &) = delete;
+
+	private:
+		const char *name;
+		std::int64_t start;
+	};
+
+	/**
+	 * Records a point in time inside the current span, if that is recorded.
+	 * \param name See span::span().
+	 */
+	void instant(const char *name) noexcept;
+}
+}
+
+#ifdef TICTACTOE_TRACING
+#define TICTACTOE_TRACE_CONCAT_IMPL(a, b) a##b
+#define TICTACTOE_TRACE_CONCAT(a, b) TICTACTOE_TRACE_CONCAT_IMPL(a, b)
+#define TICTACTOE_TRACE_SPAN(name) ::tictactoe::tracing::span TICTACTOE_TRACE_CONCAT(tictactoe_trace_span_, __LINE__)(name)
+#define TICTACTOE_TRACE_INSTANT(name) ::tictactoe::tracing::instant(name)
+#else
+#define TICTACTOE_TRACE_SPAN(name) static_cast<void>(0)
+#define TICTACTOE_TRACE_INSTANT(name) static_cast<void>(0)
+#endif
+
+#endif // TICTACTOE_TRACING_HPP_INCLUDED
@@ -0,0 +1,71 @@
+#include "transposition_table.hpp"
+
+#include <cassert>
+
+namespace {
+	// data layout: value (16 bit, biased) | depth (8 bit) | bound (8 bit) | move (8 bit)
+	constexpr int value_bias = 0x8000;
+
+	std::uint64_t pack(const tictactoe::transposition_table::entry &value) {
+		assert(-value_bias <= value.value && value.value < value_bias);
+		assert(value.depth <= 0xff && value.move <= 0xff);
+		return
+			(static_cast<std::uint64_t>(value.value + value_bias) << 24) |
+			(static_cast<std::uint64_t>(value.depth) << 16) |
+			(static_cast<std::uint64_t>(value.type) << 8) |
+			static_cast<std::uint64_t>(value.move);
+	}
+
+	tictactoe::transposition_table::entry unpack(std::uint64_t data) {
+		tictactoe::transposition_table::entry result;
+		result.value = static_cast<int>((data >> 24) & 0xffff) - value_bias;
+		result.depth = static_cast<unsigned>((data >> 16) & 0xff);
+		result.type  = static_cast<tictactoe::transposition_table::bound>((data >> 8) & 0xff);
+		result.move  = static_cast<unsigned>(data & 0xff);
+		return result;
+	}
+}
+
+constexpr unsigned tictactoe::transposition_table::no_move;
+
+tictactoe::transposition_table::transposition_table(unsigned size_log2)
+: mask((std::uint64_t(1) << size_log2) - 1)
+, slots(new slot[mask + 1]) {
+	clear();
+}
+
+bool tictactoe::transposition_table::probe(std::uint64_t key, entry &result) const {
+	const slot &s = slots[key & mask];
+	const std::uint64_t
+		data  = s.data.load(std::memory_order_relaxed),
+		check = s.check.load(std::memory_order_relaxed);
+
+	// an empty slot has check == data == 0, which only matches key 0
+	if ((check ^ data) != key || 0 == data) {
+		return false;
+	}
+	result = unpack(data);
+	return true;
+}
+
+void tictactoe::transposition_table::store(std::uint64_t key, const entry &value) {
+	slot &s = slots[key & mask];
+	const std::uint64_t
+		old_data  = s.data.load(std::memory_order_relaxed),
+		old_check = s.check.load(std::memory_order_relaxed);
+
+	if (0 != old_data && (old_check ^ old_data) != key && unpack(old_data).depth > value.depth) {
+		return; // keep the deeper result of another position
+	}
+
+	const std::uint64_t data = pack(value);
+	s.check.store(key ^ data, std::memory_order_relaxed);
+	s.data.store(data, std::memory_order_relaxed);
+}
+
+void tictactoe::transposition_table::clear() {
+	for(std::uint64_t index = 0; index <= mask; ++index) {
+		slots[index].check.store(0, std::memory_order_relaxed);
+		slots[index].data.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,78 @@
+#ifndef TICTACTOE_TRANSPOSITION_TABLE_HPP_INCLUDED
+#define TICTACTOE_TRANSPOSITION_TABLE_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace tictactoe {
+
+/**
+ * A fixed size hash table of search results that can be shared between any
+ * number of search threads without locking.
+ * Each slot stores its key xor'ed with its data, so a slot that was torn by
+ * two concurrent writes is detected on probe and simply treated as a miss.
+ */
+struct transposition_table {
+	/**
+	 * How the stored value relates to the true value of the position.
+	 */
+	enum class bound : unsigned {
+		exact,
+		lower,
+		upper
+	};
+
+	struct entry {
+		int value;
+		unsigned depth;
+		bound type;
+		/**
+		 * The best move found, or no_move.
+		 */
+		unsigned move;
+	};
+
+	static constexpr unsigned no_move = 0xff;
+
+	/**
+	 * Create an empty table.
+	 * \param size_log2 The binary logarithm of the number of slots.
+	 */
+	explicit transposition_table(unsigned size_log2 = 20);
+
+	/**
+	 * Looks up a position.
+	 * \param key The hash of the position.
+	 * \param result Receives the stored entry on success.
+	 * \return true iff an entry for key was found.
+	 */
+	bool probe(std::uint64_t key, entry &result) const;
+
+	/**
+	 * Stores a search result, replacing the previous occupant of the slot
+	 * unless it belongs to a different position and was searched deeper.
+	 * \param key The hash of the position.
+	 * \param value The entry to store; value must fit into 16 bits, depth and
+	 *        move into 8 bits each.
+	 */
+	void store(std::uint64_t key, const entry &value);
+
+	/**
+	 * Removes all entries.
+	 */
+	void clear();
+
+private:
+	struct slot {
+		std::atomic<std::uint64_t> check;
+		std::atomic<std::uint64_t> data;
+	};
+
+	std::uint64_t mask;
+	std::unique_ptr<slot[]> slots;
+};
+
+}
+
+#endif // TICTACTOE_TRANSPOSITION_TABLE_HPP_INCLUDED
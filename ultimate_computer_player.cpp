@@ -0,0 +1,304 @@
+#include "ultimate_computer_player.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "ultimate_game.hpp"
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+	typedef tictactoe::ultimate_position::size_type size_type;
+
+	constexpr int win_value = 10000;
+	constexpr int win_bound = win_value - 1000; // anything above is a forced win
+	constexpr int infinity = win_value + 1;
+
+	// rows, columns and diagonals of a 3x3 board as tile masks
+	constexpr std::uint32_t lines[] = {
+		0x007, 0x038, 0x1c0,
+		0x049, 0x092, 0x124,
+		0x111, 0x054
+	};
+
+	int popcount(std::uint32_t mask) {
+		int result = 0;
+		for(; mask; mask &= mask - 1) {
+			++result;
+		}
+		return result;
+	}
+
+	// scores open lines of a 3x3 board from the point of view of mine
+	int line_score(std::uint32_t mine, std::uint32_t theirs, int one, int two) {
+		int score = 0;
+		for(const std::uint32_t line : lines) {
+			if (!(line & theirs)) {
+				const int count = popcount(line & mine);
+				score += (count == 2) ? two : (count == 1) ? one : 0;
+			}
+			if (!(line & mine)) {
+				const int count = popcount(line & theirs);
+				score -= (count == 2) ? two : (count == 1) ? one : 0;
+			}
+		}
+		return score;
+	}
+
+	// static evaluation from the point of view of the player to move
+	int evaluate(const tictactoe::ultimate_position &position) {
+		const unsigned
+			mine_shift = (position.current_player() == tictactoe::field::tile::player1) ? 0 : 16,
+			theirs_shift = 16 - mine_shift;
+		const std::uint32_t
+			meta = position.packed_meta_board(),
+			meta_mine = (meta >> mine_shift) & 0x1ff,
+			meta_theirs = (meta >> theirs_shift) & 0x1ff;
+
+		int score =
+			100 * (popcount(meta_mine) - popcount(meta_theirs)) +
+			line_score(meta_mine, meta_theirs, 0, 200);
+
+		for(size_type board = 0; board < tictactoe::ultimate_position::board_size; ++board) {
+			if (position.board_closed(board)) {
+				continue;
+			}
+			const std::uint32_t
+				tiles = position.packed_board(board),
+				mine = (tiles >> mine_shift) & 0x1ff,
+				theirs = (tiles >> theirs_shift) & 0x1ff;
+			// the center and corner boards take part in more meta lines
+			const int weight = (board == 4) ? 3 : (board % 2) ? 1 : 2;
+			score += weight * (line_score(mine, theirs, 0, 8) + 3 * (popcount(mine & 0x010) - popcount(theirs & 0x010)));
+		}
+		return score;
+	}
+
+	int value_to_table(int value, unsigned ply) {
+		return (value > win_bound) ? value + ply : (value < -win_bound) ? value - ply : value;
+	}
+
+	int value_from_table(int value, unsigned ply) {
+		return (value > win_bound) ? value - ply : (value < -win_bound) ? value + ply : value;
+	}
+
+	struct shared_search {
+		tictactoe::transposition_table &table;
+		std::atomic<bool> stop;
+		clock_type::time_point deadline;
+		unsigned max_depth;
+	};
+
+	struct search_thread {
+		search_thread(shared_search &shared, unsigned id)
+		: shared(shared)
+		, id(id)
+		, nodes(0)
+		, completed_depth(0)
+		, best_move(0)
+		, aborted(false) {}
+
+		bool should_stop() {
+			if (0 == (++nodes & 0x3ff) && clock_type::now() >= shared.deadline) {
+				shared.stop = true;
+			}
+			// the main thread always completes its first iteration so there
+			// is a move to play
+			return shared.stop && (id != 0 || completed_depth > 0);
+		}
+
+		// moves the preferred move to the front and, on helper threads,
+		// rotates the rest to make the threads diverge
+		void order_moves(size_type *moves, size_type num_moves, unsigned preferred) {
+			if (id != 0 && num_moves > 1) {
+				std::rotate(moves, moves + (id % num_moves), moves + num_moves);
+			}
+			for(size_type index = 0; index < num_moves; ++index) {
+				if (moves[index] == preferred) {
+					std::rotate(moves, moves + index, moves + index + 1);
+					break;
+				}
+			}
+		}
+
+		int negamax(const tictactoe::ultimate_position &position, unsigned depth, int alpha, int beta, unsigned ply) {
+			if (should_stop()) {
+				aborted = true;
+				return 0;
+			}
+
+			if (position.game_over()) {
+				// only the player that just moved can have won
+				return (position.winner() == tictactoe::field::tile::empty) ? 0 : -(win_value - static_cast<int>(ply));
+			}
+			if (0 == depth) {
+				return evaluate(position);
+			}
+
+			const int original_alpha = alpha;
+			unsigned table_move = tictactoe::transposition_table::no_move;
+			tictactoe::transposition_table::entry entry;
+			if (shared.table.probe(position.hash(), entry)) {
+				table_move = entry.move;
+				if (entry.depth >= depth) {
+					const int value = value_from_table(entry.value, ply);
+					if (
+						entry.type == tictactoe::transposition_table::bound::exact ||
+						(entry.type == tictactoe::transposition_table::bound::lower && value >= beta) ||
+						(entry.type == tictactoe::transposition_table::bound::upper && value <= alpha)
+					) {
+						return value;
+					}
+				}
+			}
+
+			size_type moves[tictactoe::ultimate_position::size];
+			const size_type num_moves = position.legal_moves(moves);
+			order_moves(moves, num_moves, table_move);
+
+			int best_value = -infinity;
+			size_type best = moves[0];
+			for(size_type index = 0; index < num_moves; ++index) {
+				tictactoe::ultimate_position child(position);
+				child.make_move(moves[index]);
+				const int value = -negamax(child, depth - 1, -beta, -alpha, ply + 1);
+				if (aborted) {
+					return 0;
+				}
+				if (value > best_value) {
+					best_value = value;
+					best = moves[index];
+				}
+				alpha = std::max(alpha, value);
+				if (alpha >= beta) {
+					break;
+				}
+			}
+
+			tictactoe::transposition_table::entry result;
+			result.value = value_to_table(best_value, ply);
+			result.depth = depth;
+			result.move = static_cast<unsigned>(best);
+			result.type =
+				(best_value <= original_alpha) ? tictactoe::transposition_table::bound::upper :
+				(best_value >= beta) ? tictactoe::transposition_table::bound::lower :
+				tictactoe::transposition_table::bound::exact;
+			shared.table.store(position.hash(), result);
+			return best_value;
+		}
+
+		void iterate(const tictactoe::ultimate_position &root) {
+			size_type moves[tictactoe::ultimate_position::size];
+			const size_type num_moves = root.legal_moves(moves);
+			best_move = moves[0];
+
+			for(unsigned depth = 1 + id % 2; depth <= shared.max_depth; ++depth) {
+				order_moves(moves, num_moves, static_cast<unsigned>(best_move));
+
+				int alpha = -infinity, best_value = -infinity;
+				size_type iteration_best = moves[0];
+				for(size_type index = 0; index < num_moves; ++index) {
+					tictactoe::ultimate_position child(root);
+					child.make_move(moves[index]);
+					const int value = -negamax(child, depth - 1, -infinity, -alpha, 1);
+					if (aborted) {
+						return;
+					}
+					if (value > best_value) {
+						best_value = value;
+						iteration_best = moves[index];
+					}
+					alpha = std::max(alpha, value);
+				}
+
+				best_move = iteration_best;
+				completed_depth = depth;
+				if (best_value > win_bound || best_value < -win_bound) {
+					break; // the result is proven, deeper searches won't change it
+				}
+			}
+		}
+
+		shared_search &shared;
+		unsigned id;
+		std::uint64_t nodes;
+		unsigned completed_depth;
+		size_type best_move;
+		bool aborted;
+	};
+}
+
+double tictactoe::ultimate_computer_player::search_statistics::nodes_per_second() const {
+	return (elapsed.count() > 0)
+		? nodes / elapsed.count()
+		: 0;
+}
+
+tictactoe::ultimate_computer_player::ultimate_computer_player(
+	unsigned threads,
+	std::chrono::milliseconds move_time,
+	unsigned max_depth
+)
+: num_threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+, move_time(move_time)
+, max_depth(std::min(max_depth, 0xffu))
+, table()
+, statistics() {
+	std::stringstream namebuilder;
+	namebuilder << "Colossus (" << num_threads << (num_threads == 1 ? " thread)" : " threads)");
+	player_name = namebuilder.str();
+}
+
+std::string tictactoe::ultimate_computer_player::name() const {
+	return player_name;
+}
+
+void tictactoe::ultimate_computer_player::make_move(ultimate_make_move_interface game) {
+	const ultimate_position root(game.position());
+	root.print(std::cout);
+	std::cout << '\n';
+
+	const clock_type::time_point start = clock_type::now();
+	shared_search shared{table, {false}, start + move_time, max_depth};
+
+	std::vector<search_thread> searchers;
+	searchers.reserve(num_threads);
+	for(unsigned id = 0; id < num_threads; ++id) {
+		searchers.emplace_back(shared, id);
+	}
+
+	std::vector<std::thread> helpers;
+	helpers.reserve(num_threads - 1);
+	for(unsigned id = 1; id < num_threads; ++id) {
+		helpers.emplace_back([&searchers, &root, id]() {
+			searchers[id].iterate(root);
+		});
+	}
+	searchers[0].iterate(root);
+	shared.stop = true;
+	for(auto &helper : helpers) {
+		helper.join();
+	}
+
+	statistics.nodes = 0;
+	for(const auto &searcher : searchers) {
+		statistics.nodes += searcher.nodes;
+	}
+	statistics.elapsed = clock_type::now() - start;
+	statistics.depth = searchers[0].completed_depth;
+	statistics.threads = num_threads;
+
+	std::cout <<
+		player_name << ": searched " << statistics.nodes << " nodes to depth " <<
+		statistics.depth << " in " << statistics.elapsed.count() << "s (" <<
+		static_cast<std::uint64_t>(statistics.nodes_per_second()) << " nodes/s)\n";
+
+	game.make_move(searchers[0].best_move);
+}
+
+const tictactoe::ultimate_computer_player::search_statistics &tictactoe::ultimate_computer_player::last_search() const {
+	return statistics;
+}
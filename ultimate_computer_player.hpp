@@ -0,0 +1,63 @@
+#ifndef TICTACTOE_ULTIMATE_COMPUTER_PLAYER_HPP_INCLUDED
+#define TICTACTOE_ULTIMATE_COMPUTER_PLAYER_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+
+#include "transposition_table.hpp"
+#include "ultimate_player.hpp"
+
+namespace tictactoe {
+
+/**
+ * A computer player for ultimate tic-tac-toe.
+ * It runs an iterative deepening alpha-beta search on several threads that
+ * only cooperate through a shared transposition table (Lazy SMP).
+ */
+struct ultimate_computer_player : ultimate_player {
+	/**
+	 * Statistics about a single search.
+	 */
+	struct search_statistics {
+		std::uint64_t nodes;
+		std::chrono::duration<double> elapsed;
+		unsigned depth;
+		unsigned threads;
+
+		double nodes_per_second() const;
+	};
+
+	/**
+	 * Create a new computer player.
+	 * \param threads The number of search threads; 0 uses one thread per
+	 *        hardware thread.
+	 * \param move_time The time budget for each move. The first iteration is
+	 *        always completed, regardless of the budget.
+	 * \param max_depth The maximum search depth in plies.
+	 */
+	explicit ultimate_computer_player(
+		unsigned threads = 0,
+		std::chrono::milliseconds move_time = std::chrono::milliseconds(1000),
+		unsigned max_depth = 64
+	);
+
+	std::string name() const override;
+	void make_move(ultimate_make_move_interface) override;
+
+	/**
+	 * Returns the statistics of the most recent search.
+	 */
+	const search_statistics &last_search() const;
+
+private:
+	std::string player_name;
+	unsigned num_threads;
+	std::chrono::milliseconds move_time;
+	unsigned max_depth;
+	transposition_table table;
+	search_statistics statistics;
+};
+
+}
+
+#endif // TICTACTOE_ULTIMATE_COMPUTER_PLAYER_HPP_INCLUDED
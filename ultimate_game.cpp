@@ -0,0 +1,371 @@
+#include "ultimate_game.hpp"
+
+#include <cassert>
+
+#include <array>
+#include <iostream>
+
+#include "tracing.hpp"
+#include "ultimate_player.hpp"
+
+namespace {
+	typedef tictactoe::ultimate_position::size_type size_type;
+
+	constexpr std::uint32_t board_mask = 0x1ff;
+	constexpr unsigned player2_shift = 16;
+
+	// All 512 tile masks of a 3x3 board, classified once through
+	// field::check_win_condition so sub-boards and the meta-board follow
+	// exactly the rules of the plain game.
+	const std::array<bool, 512> &line_table() {
+		static const std::array<bool, 512> table = [] {
+			std::array<bool, 512> result;
+			for(std::uint32_t mask = 0; mask < result.size(); ++mask) {
+				tictactoe::field board;
+				for(tictactoe::field::size_type index = 0; index < board.size(); ++index) {
+					if (mask & (1u << index)) {
+						board[index] = tictactoe::field::tile::player1;
+					}
+				}
+
+				result[mask] = false;
+				for(tictactoe::field::size_type index = 0; index < board.size(); ++index) {
+					if ((mask & (1u << index)) && board.check_win_condition(index)) {
+						result[mask] = true;
+						break;
+					}
+				}
+			}
+			return result;
+		}();
+		return table;
+	}
+
+	struct zobrist_keys {
+		zobrist_keys() {
+			// splitmix64 with a fixed seed, so hashes are reproducible
+			std::uint64_t seed = 0x9e3779b97f4a7c15ull;
+			auto next = [&seed]() {
+				std::uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				return z ^ (z >> 31);
+			};
+			for(auto &player_keys : tiles) {
+				for(auto &key : player_keys) {
+					key = next();
+				}
+			}
+			for(auto &key : next_board) {
+				key = next();
+			}
+			side = next();
+		}
+
+		std::uint64_t tiles[2][tictactoe::ultimate_position::size];
+		std::uint64_t next_board[tictactoe::ultimate_position::board_size + 1];
+		std::uint64_t side;
+	};
+
+	const zobrist_keys &keys() {
+		static const zobrist_keys instance;
+		return instance;
+	}
+}
+
+constexpr tictactoe::ultimate_position::size_type tictactoe::ultimate_position::board_size;
+constexpr tictactoe::ultimate_position::size_type tictactoe::ultimate_position::size;
+constexpr tictactoe::ultimate_position::size_type tictactoe::ultimate_position::any_board;
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::ultimate_position
+//
+
+tictactoe::ultimate_position::ultimate_position()
+: boards()
+, meta(0)
+, closed(0)
+, next(any_board)
+, side(0)
+, zobrist(keys().next_board[any_board]) {}
+
+bool tictactoe::ultimate_position::completes_line(std::uint32_t mask) {
+	return line_table()[mask & board_mask];
+}
+
+tictactoe::field::tile tictactoe::ultimate_position::operator[](size_type index) const {
+	assert(index < size);
+	const std::uint32_t
+		board = boards[index / board_size],
+		bit = 1u << (index % board_size);
+	return
+		(board & bit) ? field::tile::player1 :
+		(board & (bit << player2_shift)) ? field::tile::player2 :
+		field::tile::empty;
+}
+
+tictactoe::field::tile tictactoe::ultimate_position::board_winner(size_type board) const {
+	assert(board < board_size);
+	const std::uint32_t bit = 1u << board;
+	return
+		(meta & bit) ? field::tile::player1 :
+		(meta & (bit << player2_shift)) ? field::tile::player2 :
+		field::tile::empty;
+}
+
+bool tictactoe::ultimate_position::board_closed(size_type board) const {
+	assert(board < board_size);
+	return closed & (1u << board);
+}
+
+tictactoe::ultimate_position::size_type tictactoe::ultimate_position::next_board() const {
+	return next;
+}
+
+tictactoe::field::tile tictactoe::ultimate_position::current_player() const {
+	return side ? field::tile::player2 : field::tile::player1;
+}
+
+tictactoe::field::tile tictactoe::ultimate_position::opponent_player() const {
+	return side ? field::tile::player1 : field::tile::player2;
+}
+
+bool tictactoe::ultimate_position::is_legal(size_type index) const {
+	if (index >= size || game_over()) {
+		return false;
+	}
+	const size_type board = index / board_size;
+	if (board_closed(board) || (next != any_board && next != board)) {
+		return false;
+	}
+	return (*this)[index] == field::tile::empty;
+}
+
+tictactoe::ultimate_position::size_type tictactoe::ultimate_position::legal_moves(size_type *moves) const {
+	if (game_over()) {
+		return 0;
+	}
+
+	size_type num_moves = 0;
+	const size_type
+		first_board = (next == any_board) ? 0 : next,
+		last_board = (next == any_board) ? board_size : next + 1;
+	for(size_type board = first_board; board < last_board; ++board) {
+		if (board_closed(board)) {
+			continue;
+		}
+		const std::uint32_t occupied = (boards[board] | (boards[board] >> player2_shift)) & board_mask;
+		for(size_type tile = 0; tile < board_size; ++tile) {
+			if (!(occupied & (1u << tile))) {
+				moves[num_moves++] = board * board_size + tile;
+			}
+		}
+	}
+	return num_moves;
+}
+
+void tictactoe::ultimate_position::make_move(size_type index) {
+	assert(is_legal(index));
+
+	const zobrist_keys &key = keys();
+	const size_type
+		board = index / board_size,
+		tile = index % board_size;
+	const unsigned shift = side ? player2_shift : 0;
+
+	boards[board] |= (1u << tile) << shift;
+	zobrist ^= key.tiles[side][index];
+
+	if (completes_line(boards[board] >> shift)) {
+		meta |= (1u << board) << shift;
+		closed |= 1u << board;
+	}
+	else if (board_mask == ((boards[board] | (boards[board] >> player2_shift)) & board_mask)) {
+		closed |= 1u << board;
+	}
+
+	zobrist ^= key.next_board[next];
+	next = board_closed(tile) ? any_board : tile;
+	zobrist ^= key.next_board[next];
+
+	side ^= 1;
+	zobrist ^= key.side;
+}
+
+bool tictactoe::ultimate_position::game_over() const {
+	return closed == board_mask || winner() != field::tile::empty;
+}
+
+tictactoe::field::tile tictactoe::ultimate_position::winner() const {
+	return
+		completes_line(meta) ? field::tile::player1 :
+		completes_line(meta >> player2_shift) ? field::tile::player2 :
+		field::tile::empty;
+}
+
+tictactoe::field tictactoe::ultimate_position::meta_field() const {
+	field result;
+	for(size_type board = 0; board < board_size; ++board) {
+		result[board] = board_winner(board);
+	}
+	return result;
+}
+
+void tictactoe::ultimate_position::print(std::ostream &os) const {
+	print(
+		os,
+		[](std::string::size_type length, field::size_type /* index; unused */) -> std::string {
+			return std::string(length, ' ');
+		}
+	);
+}
+
+void tictactoe::ultimate_position::print(std::ostream &os, field::empty_tile_caption_callback on_empty) const {
+	const size_type order = 3;
+	const char * const row_separator = "\n +=======+=======+=======+ \n";
+
+	for(size_type row = 0; row < order * order; ++row) {
+		os << ((0 == row % order) ? row_separator : "\n");
+		for(size_type column = 0; column < order * order; ++column) {
+			const size_type
+				board = (row / order) * order + column / order,
+				tile = (row % order) * order + column % order,
+				index = board * board_size + tile;
+
+			os << ((0 == column % order) ? " | " : " ");
+			switch((*this)[index]) {
+			case field::tile::empty:
+				os << on_empty(1, index);
+				break;
+			case field::tile::player1:
+				os << 'X';
+				break;
+			case field::tile::player2:
+				os << 'O';
+				break;
+			// no default case - issue warning if cases are not specifically handled
+			}
+		}
+		os << " | ";
+	}
+	os << row_separator;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::ultimate_game_state
+//
+
+namespace tictactoe {
+	struct ultimate_game_state {
+		ultimate_game_state()
+		: position()
+		, current_player(position.current_player())
+		, can_move(false) {}
+
+		void prepare_next_move() {
+			if (can_move) {
+				throw rule_violation_exception("You have not made a move.");
+			}
+			current_player = position.current_player();
+			can_move = true;
+		}
+
+		ultimate_position position;
+		field::tile current_player;
+		bool can_move;
+	};
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// tictactoe::ultimate_make_move_interface
+//
+
+tictactoe::ultimate_make_move_interface::ultimate_make_move_interface(ultimate_game_state &state)
+: state(state) {}
+
+const tictactoe::ultimate_position &tictactoe::ultimate_make_move_interface::position() const {
+	return state.position;
+}
+
+void tictactoe::ultimate_make_move_interface::make_move(field::size_type index) {
+	if (!state.can_move) {
+		throw rule_violation_exception("You have already made your move.");
+	}
+	if (index >= ultimate_position::size) {
+		throw rule_violation_exception("The chosen tile is invalid.");
+	}
+	if (state.position[index] != field::tile::empty) {
+		throw rule_violation_exception("The chosen tile is already occupied.");
+	}
+	if (!state.position.is_legal(index)) {
+		throw rule_violation_exception("The chosen tile is not on a playable board.");
+	}
+	state.position.make_move(index);
+	state.can_move = false;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+// main game function
+//
+
+tictactoe::ultimate_player *tictactoe::ultimate_game(ultimate_player &player1, ultimate_player &player2) {
+	TICTACTOE_TRACE_SPAN("ultimate_game");
+	ultimate_game_state state;
+
+	auto current_player = [&]() -> ultimate_player& {
+		return (state.current_player == field::tile::player1) ? player1 : player2;
+	};
+	auto opponent_player = [&]() -> ultimate_player& {
+		return (state.current_player == field::tile::player1) ? player2 : player1;
+	};
+
+	try {
+		while(!state.position.game_over()) {
+			state.prepare_next_move();
+			std::cout << current_player().name() << ": Your turn!\n";
+			{
+				TICTACTOE_TRACE_SPAN("make_move");
+				current_player().make_move(ultimate_make_move_interface(state));
+			}
+			if (state.can_move) {
+				throw rule_violation_exception("You have not made a move.");
+			}
+		}
+
+		std::cout << "Game over!\n";
+		state.position.print(std::cout);
+		std::cout << '\n';
+
+		if (state.position.winner() != field::tile::empty) {
+			std::cout <<
+				"Congratulations, " << current_player().name() << ", you won!\n" <<
+				opponent_player().name() << ", better luck next time.\n";
+			return &(current_player());
+		}
+		else {
+			std::cout <<
+				"It's a tie. Why not give it another try and play again?\n";
+			return nullptr;
+		}
+	}
+	catch(rule_violation_exception &e) {
+		std::cout <<
+			current_player().name() << " has violated the rules.\n"
+			"Congratulations, " << opponent_player().name() << ", you won!\n";
+		return &(opponent_player());
+	}
+	catch(...) {
+		std::cout <<
+			"Something went wrong during " << current_player().name() << "s turn.\n"
+			"The game is called off.\n";
+		throw;
+	}
+}
@@ -0,0 +1,193 @@
+#ifndef TICTACTOE_ULTIMATE_GAME_HPP_INCLUDED
+#define TICTACTOE_ULTIMATE_GAME_HPP_INCLUDED
+
+#include <cstdint>
+#include <ostream>
+
+#include "field.hpp"
+#include "game.hpp"
+
+namespace tictactoe {
+
+struct ultimate_game_state;
+struct ultimate_player;
+
+/**
+ * A position of ultimate tic-tac-toe: nine 3x3 sub-boards arranged on a 3x3
+ * meta-board. Whoever wins a sub-board claims the respective tile of the
+ * meta-board; the tile a move is played on selects the sub-board the opponent
+ * has to play on next.
+ *
+ * Tiles are addressed by a flat index board * 9 + tile, where both board and
+ * tile are flat indices into a 3x3 field.
+ *
+ * The position is trivially copyable and does not allocate, so search code
+ * can copy it freely.
+ */
+struct ultimate_position {
+	typedef field::size_type size_type;
+
+	/**
+	 * The number of tiles per sub-board and the number of sub-boards.
+	 */
+	static constexpr size_type board_size = 9;
+
+	/**
+	 * The total number of tiles.
+	 */
+	static constexpr size_type size = board_size * board_size;
+
+	/**
+	 * Returned by next_board() when the player to move may choose freely.
+	 */
+	static constexpr size_type any_board = board_size;
+
+	/**
+	 * Create the initial position.
+	 */
+	ultimate_position();
+
+	/**
+	 * Returns the state of the tile with the given flat index.
+	 */
+	field::tile operator[](size_type index) const;
+
+	/**
+	 * Returns the player that has won the given sub-board, or
+	 * field::tile::empty if it is undecided or drawn.
+	 */
+	field::tile board_winner(size_type board) const;
+
+	/**
+	 * Returns whether the given sub-board is won or full.
+	 */
+	bool board_closed(size_type board) const;
+
+	/**
+	 * Returns the sub-board the current player has to play on, or any_board.
+	 */
+	size_type next_board() const;
+
+	/**
+	 * Returns the state the current player plays.
+	 */
+	field::tile current_player() const;
+
+	/**
+	 * Returns the state the opponent plays.
+	 */
+	field::tile opponent_player() const;
+
+	/**
+	 * Returns whether the current player may play the tile with the given
+	 * flat index.
+	 */
+	bool is_legal(size_type index) const;
+
+	/**
+	 * Writes all legal moves to moves, which must have room for size
+	 * elements.
+	 * \return The number of legal moves.
+	 */
+	size_type legal_moves(size_type *moves) const;
+
+	/**
+	 * Plays the current player's state on the given tile and passes the turn.
+	 * \param index The flat index of the tile; is_legal(index) must hold.
+	 */
+	void make_move(size_type index);
+
+	/**
+	 * Returns whether the game is decided or no legal move is left.
+	 */
+	bool game_over() const;
+
+	/**
+	 * Returns the player that has won the meta-board, or field::tile::empty.
+	 */
+	field::tile winner() const;
+
+	/**
+	 * Returns the Zobrist hash of the position, including the player to move
+	 * and the sub-board restriction.
+	 */
+	std::uint64_t hash() const noexcept { return zobrist; }
+
+	/**
+	 * Returns the meta-board as a field of won sub-boards.
+	 */
+	field meta_field() const;
+
+	/**
+	 * Prints the position.
+	 * \param os The output stream to print to.
+	 */
+	void print(std::ostream &os) const;
+
+	/**
+	 * Prints the position using a given callback to generate captions for
+	 * empty tiles, see field::print(std::ostream&, empty_tile_caption_callback).
+	 */
+	void print(std::ostream &os, field::empty_tile_caption_callback callback) const;
+
+	/**
+	 * Returns the packed tiles of the given sub-board: bits 0-8 hold the
+	 * tiles of player 1, bits 16-24 the tiles of player 2.
+	 */
+	std::uint32_t packed_board(size_type board) const noexcept { return boards[board]; }
+
+	/**
+	 * Returns the packed meta-board of won sub-boards, see packed_board().
+	 */
+	std::uint32_t packed_meta_board() const noexcept { return meta; }
+
+	/**
+	 * Returns whether the given 9 bit tile mask of a 3x3 board contains a
+	 * full row, column or diagonal.
+	 */
+	static bool completes_line(std::uint32_t mask);
+
+private:
+	std::uint32_t boards[board_size];
+	std::uint32_t meta;
+	std::uint16_t closed;
+	std::uint8_t next;
+	std::uint8_t side;
+	std::uint64_t zobrist;
+};
+
+struct ultimate_make_move_interface {
+	/**
+	 * Create a new move interface from a game state.
+	 */
+	explicit ultimate_make_move_interface(ultimate_game_state &);
+
+	/**
+	 * The position that is played on.
+	 */
+	const ultimate_position &position() const;
+
+	/**
+	 * Makes a move by playing the current players state to the tile with the
+	 * given flat index.
+	 * \throw rule_violation_exception in case the move is illegal.
+	 * \note As with game_make_move_interface::make_move, only one call per
+	 *       game state is allowed.
+	 */
+	void make_move(field::size_type index);
+
+private:
+	ultimate_game_state &state;
+};
+
+/**
+ * Start a game of ultimate tic-tac-toe with two players.
+ * \param player1 The first player. This player will have the first move.
+ * \param player2 The second player.
+ * \return A pointer to the winning player or nullptr in case of a draw.
+ */
+ultimate_player *ultimate_game(ultimate_player &player1, ultimate_player &player2);
+
+}
+
+#endif // TICTACTOE_ULTIMATE_GAME_HPP_INCLUDED
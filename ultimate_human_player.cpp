@@ -0,0 +1,74 @@
+#include "ultimate_human_player.hpp"
+
+#include <iostream>
+#include <ostream>
+#include <sstream>
+
+#include "ultimate_game.hpp"
+
+namespace {
+	// boards and tiles are numbered like the numpad (see human_player)
+	tictactoe::field::size_type numpad_index(tictactoe::field::size_type index) {
+		const tictactoe::field::size_type
+			order = 3,
+			old_x = index % order,
+			old_y = index / order;
+		return (order - old_y - 1) * order + old_x;
+	}
+}
+
+tictactoe::ultimate_human_player::ultimate_human_player(std::string name)
+: player_name(name) {}
+
+std::string tictactoe::ultimate_human_player::name() const {
+	return player_name;
+}
+
+void tictactoe::ultimate_human_player::make_move(ultimate_make_move_interface game) {
+	const ultimate_position &position = game.position();
+	const field::size_type board_size = ultimate_position::board_size;
+
+	position.print(
+		std::cout,
+		[&](std::string::size_type length, field::size_type index) {
+			if (!position.is_legal(index)) {
+				return std::string(length, ' ');
+			}
+			std::stringstream ss;
+			ss << numpad_index(index % board_size) + 1;
+			return ss.str();
+		}
+	);
+
+	while(std::cin) {
+		try {
+			const bool choose_board = position.next_board() == ultimate_position::any_board;
+			(std::cout << (choose_board
+				? "\nWhich board and tile do you want to play? "
+				: "\nWhich tile do you want to play? ")).flush();
+
+			std::string line;
+			std::getline(std::cin, line);
+			std::stringstream ss(line);
+
+			field::size_type board = position.next_board(), tile;
+			if ((!choose_board || ss >> board) && ss >> tile && 0 < tile && tile <= board_size) {
+				if (choose_board) {
+					if (0 == board || board_size < board) {
+						std::cout << "That's not a valid board number ... try again." << std::endl;
+						continue;
+					}
+					board = numpad_index(board - 1); // revert offset and index transformation
+				}
+				game.make_move(board * board_size + numpad_index(tile - 1));
+				break;
+			}
+			else {
+				std::cout << "That's not a valid tile number ... try again." << std::endl;
+			}
+		}
+		catch(rule_violation_exception &e) {
+			std::cout << e.what() << "\nTry again." << std::endl;
+		}
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef TICTACTOE_ULTIMATE_HUMAN_PLAYER_HPP_INCLUDED
+#define TICTACTOE_ULTIMATE_HUMAN_PLAYER_HPP_INCLUDED
+
+#include "ultimate_player.hpp"
+
+namespace tictactoe {
+
+struct ultimate_human_player : ultimate_player {
+	/**
+	 * Create a new human player.
+	 * \param name The name of the player.
+	 */
+	ultimate_human_player(std::string name);
+
+	std::string name() const override;
+	void make_move(ultimate_make_move_interface) override;
+
+private:
+	std::string player_name;
+};
+
+}
+
+#endif // TICTACTOE_ULTIMATE_HUMAN_PLAYER_HPP_INCLUDED
@@ -0,0 +1,26 @@
+#ifndef TICTACTOE_ULTIMATE_PLAYER_HPP_INCLUDED
+#define TICTACTOE_ULTIMATE_PLAYER_HPP_INCLUDED
+
+#include <string>
+
+namespace tictactoe {
+
+struct ultimate_make_move_interface;
+
+struct ultimate_player {
+	virtual ~ultimate_player() = default;
+
+	/**
+	 * Returns the name of the current player.
+	 */
+	virtual std::string name() const = 0;
+
+	/**
+	 * Determines and commits the next move.
+	 */
+	virtual void make_move(ultimate_make_move_interface) = 0;
+};
+
+}
+
+#endif // TICTACTOE_ULTIMATE_PLAYER_HPP_INCLUDED
@@ -0,0 +1,57 @@
+#include "watchdog.hpp"
+
+tictactoe::watchdog::watchdog()
+: next_id(0)
+, stopping(false)
+, thread(&watchdog::watch, this) {}
+
+tictactoe::watchdog::~watchdog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeup.notify_one();
+	thread.join();
+}
+
+tictactoe::watchdog::timer tictactoe::watchdog::arm(clock_type::time_point deadline, std::atomic<bool> &flag) {
+	timer armed;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		armed.deadline = deadline;
+		armed.id = next_id++;
+		timers.emplace(std::make_pair(armed.deadline, armed.id), &flag);
+	}
+	// the new deadline might be the earliest one
+	wakeup.notify_one();
+	return armed;
+}
+
+void tictactoe::watchdog::disarm(const timer &armed) {
+	std::lock_guard<std::mutex> lock(mutex);
+	timers.erase(std::make_pair(armed.deadline, armed.id));
+}
+
+tictactoe::watchdog &tictactoe::watchdog::shared() {
+	static watchdog instance;
+	return instance;
+}
+
+void tictactoe::watchdog::watch() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while(!stopping) {
+		if (timers.empty()) {
+			wakeup.wait(lock);
+			continue;
+		}
+
+		const clock_type::time_point now = clock_type::now();
+		if (now < timers.begin()->first.first) {
+			wakeup.wait_until(lock, timers.begin()->first.first);
+			continue;
+		}
+
+		timers.begin()->second->store(true);
+		timers.erase(timers.begin());
+	}
+}
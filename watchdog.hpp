@@ -0,0 +1,76 @@
+#ifndef TICTACTOE_WATCHDOG_HPP_INCLUDED
+#define TICTACTOE_WATCHDOG_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace tictactoe {
+
+/**
+ * A single thread that raises cancellation flags once their deadlines on the
+ * monotonic clock have passed, so any number of games can share it.
+ * Cancellation is cooperative: whoever owns the flag has to poll it.
+ */
+struct watchdog {
+	typedef std::chrono::steady_clock clock_type;
+
+	/**
+	 * Identifies an armed deadline.
+	 */
+	struct timer {
+		clock_type::time_point deadline;
+		std::uint64_t id;
+	};
+
+	/**
+	 * Create a watchdog and start its thread.
+	 */
+	watchdog();
+
+	/**
+	 * Stops the thread; flags that are still armed are never raised.
+	 */
+	~watchdog();
+
+	watchdog(const watchdog &) = delete;
+	watchdog &operator=(const watchdog &) = delete;
+
+	/**
+	 * Raises a flag once a deadline has passed.
+	 * \param deadline The point in time to raise the flag at.
+	 * \param flag The flag; it has to stay alive until the timer is disarmed.
+	 * \return The timer to disarm.
+	 */
+	timer arm(clock_type::time_point deadline, std::atomic<bool> &flag);
+
+	/**
+	 * Disarms a timer, if its flag has not been raised yet. Once this
+	 * returns, the flag won't be touched anymore.
+	 */
+	void disarm(const timer &armed);
+
+	/**
+	 * Returns the watchdog shared by all games, started on first use.
+	 */
+	static watchdog &shared();
+
+private:
+	void watch();
+
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::map<std::pair<clock_type::time_point, std::uint64_t>, std::atomic<bool> *> timers;
+	std::uint64_t next_id;
+	bool stopping;
+	std::thread thread;
+};
+
+}
+
+#endif // TICTACTOE_WATCHDOG_HPP_INCLUDED
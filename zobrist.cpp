@@ -0,0 +1,26 @@
+#include "zobrist.hpp"
+
+#include <cassert>
+
+namespace {
+	std::uint64_t mix(std::uint64_t z) {
+		// splitmix64 finalizer
+		z += 0x9e3779b97f4a7c15ull;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	std::uint64_t geometry_seed(tictactoe::field::size_type order, tictactoe::field::size_type win_length) {
+		return (static_cast<std::uint64_t>(order) << 48) ^ (static_cast<std::uint64_t>(win_length) << 40);
+	}
+}
+
+std::uint64_t tictactoe::zobrist::tile_key(field::size_type order, field::size_type win_length, field::size_type index, field::tile state) {
+	assert(state != field::tile::empty);
+	return mix(geometry_seed(order, win_length) ^ (2 * index + (state == field::tile::player2)));
+}
+
+std::uint64_t tictactoe::zobrist::side_key(field::size_type order, field::size_type win_length) {
+	return mix(geometry_seed(order, win_length) ^ 0xffffffffull);
+}
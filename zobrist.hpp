@@ -0,0 +1,27 @@
+#ifndef TICTACTOE_ZOBRIST_HPP_INCLUDED
+#define TICTACTOE_ZOBRIST_HPP_INCLUDED
+
+#include <cstdint>
+
+#include "field.hpp"
+
+namespace tictactoe {
+/**
+ * Zobrist keys for field positions. Keys are derived from the field's
+ * geometry, so positions of different sizes or win lengths never share a
+ * hash, and no key tables have to be stored.
+ */
+namespace zobrist {
+	/**
+	 * Returns the key for a state on a tile.
+	 */
+	std::uint64_t tile_key(field::size_type order, field::size_type win_length, field::size_type index, field::tile state);
+
+	/**
+	 * Returns the key that is added while player 2 is to move.
+	 */
+	std::uint64_t side_key(field::size_type order, field::size_type win_length);
+}
+}
+
+#endif // TICTACTOE_ZOBRIST_HPP_INCLUDED